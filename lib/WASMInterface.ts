@@ -1,24 +1,28 @@
-import Mutex from "./mutex";
+import {
+	addContextHost,
+	createContext,
+	destroyContext,
+	getContextHost,
+	type IContextHost,
+} from "./contexts";
+import { releaseInstance, takeInstance, trackInstance } from "./pool";
+import { instantiateShared } from "./sharedMemory";
 import {
 	type IDataType,
 	type IEmbeddedWasm,
 	decodeBase64,
+	decodeLatin1,
+	encodeBase64,
+	encodeStringInto,
 	getDigestHex,
 	getUInt8Buffer,
 	hexStringEqualsUInt8,
 	writeHexToUInt8,
 } from "./util";
+import { hasWASMLocation, loadWASMFile } from "./wasmLoader";
 
 export const MAX_HEAP = 16 * 1024;
 const WASM_FUNC_HASH_LENGTH = 4;
-const wasmMutex = new Mutex();
-
-type ThenArg<T> = T extends Promise<infer U>
-	? U
-	: // biome-ignore lint/suspicious/noExplicitAny: TS quirks
-		T extends (...args: any[]) => Promise<infer V>
-		? V
-		: T;
 
 export type IHasher = {
 	/**
@@ -32,12 +36,34 @@ export type IHasher = {
 	/**
 	 * Calculates the hash of all of the data passed to be hashed with hash.update().
 	 * Defaults to hexadecimal string
-	 * @param outputType If outputType is "binary", it returns Uint8Array. Otherwise it
-	 *                   returns hexadecimal string
+	 * @param outputType If outputType is "binary", it returns Uint8Array. "base64" and
+	 *                   "base64url" return the corresponding (unpadded for base64url)
+	 *                   strings. Otherwise it returns hexadecimal string
 	 */
 	digest: {
 		(outputType: "binary"): Uint8Array;
-		(outputType?: "hex"): string;
+		(outputType?: "hex" | "base64" | "base64url"): string;
+	};
+	/**
+	 * Calculates the hash like digest("binary"), but writes the result into
+	 * the target buffer instead of allocating a new one
+	 * @param target Buffer to write the digest into
+	 * @param offset Position in the target buffer. Defaults to 0
+	 * @returns Number of written bytes
+	 */
+	digestInto: (target: Uint8Array, offset?: number) => number;
+	/**
+	 * Calculates the hashes of multiple messages. Short messages are hashed
+	 * in batches with a single call into WebAssembly.
+	 * The internal state is reset, so init() has to be called before the next update()
+	 * @param messages Array of input data (string, Buffer or TypedArray)
+	 * @param outputType If outputType is "binary", it returns the digests concatenated
+	 *                   into a single Uint8Array. Otherwise it returns an array of
+	 *                   hexadecimal strings
+	 */
+	hashMany: {
+		(messages: IDataType[], outputType: "binary"): Uint8Array;
+		(messages: IDataType[], outputType?: "hex"): string[];
 	};
 	/**
 	 * Save the current internal state of the hasher for later resumption with load().
@@ -53,6 +79,12 @@ export type IHasher = {
 	 * compatible build of hash-wasm, an exception will be thrown.
 	 */
 	load: (state: Uint8Array) => IHasher;
+	/**
+	 * Marks the hasher as unused. The WebAssembly instance of a pooled hasher
+	 * is returned to the pool, so it can be reused by the next pooled hasher.
+	 * The hasher cannot be used after calling release()
+	 */
+	release: () => void;
 	/**
 	 * Block size in bytes
 	 */
@@ -63,18 +95,203 @@ export type IHasher = {
 	digestSize: number;
 };
 
-const wasmModuleCache = new Map<string, Promise<WebAssembly.Module>>();
+export type IDigestOutputType = "hex" | "binary" | "base64" | "base64url";
 
-export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
-	let wasmInstance = null;
-	let memoryView: Uint8Array = null;
-	let initialized = false;
+export interface IHasherOptions {
+	/**
+	 * Reuses the WebAssembly instance of a released hasher instead of
+	 * creating a new one. Pooled hashers should be released after use with
+	 * hasher.release(). Hashers which are garbage collected without being
+	 * released return their instance to the pool on platforms supporting
+	 * FinalizationRegistry
+	 */
+	pooled?: boolean;
+	/**
+	 * Stores the state of the hasher in a separate context of a single
+	 * WebAssembly instance, which is shared by the multiplexed hashers of
+	 * the same algorithm. A context only takes the size of the hash state
+	 * instead of a new instance. Supported by MD4, MD5, RIPEMD-160, SHA-1,
+	 * SHA-2, SHA-3 and Keccak. hasher.release() frees the context
+	 */
+	multiplexed?: boolean;
+}
+
+// format identifiers of Hash_EncodeDigest()
+const DIGEST_FORMAT_HEX = 0;
+const DIGEST_FORMAT_BASE64 = 1;
+const DIGEST_FORMAT_BASE64URL = 2;
 
+// layout of the buffer used by Hash_CalculateMany(), see hash-wasm.h
+const BATCH_MAX_COUNT = 256;
+const BATCH_MAX_MESSAGE_LENGTH = 4096;
+const BATCH_LENGTHS_OFFSET = BATCH_MAX_MESSAGE_LENGTH;
+const BATCH_DATA_OFFSET = BATCH_LENGTHS_OFFSET + BATCH_MAX_COUNT * 4;
+
+// position of the salt used by Pbkdf2_Calculate(), see pbkdf2_salt_offset()
+// in hash-wasm.h. Long salts are placed after salt || INT(i)
+const PBKDF2_SALT_OFFSET = 256;
+
+const wasmModuleCache = new Map<string, Promise<WebAssembly.Module>>();
+// modules which are already compiled, they can be instantiated synchronously
+const compiledModules = new Map<string, WebAssembly.Module>();
+
+function checkWebAssemblySupport() {
 	if (typeof WebAssembly === "undefined") {
 		throw new Error("WebAssembly is not supported in this environment!");
 	}
+}
+
+async function compileEmbeddedModule(
+	binary: IEmbeddedWasm,
+): Promise<WebAssembly.Module> {
+	if (!binary.data) {
+		throw new Error(
+			`The ${binary.name} binary is not embedded into this build. Use setWASMLocation()`,
+		);
+	}
+
+	return WebAssembly.compile(decodeBase64(binary.data));
+}
+
+function compileModule(binary: IEmbeddedWasm): Promise<WebAssembly.Module> {
+	if (!wasmModuleCache.has(binary.name)) {
+		const source = hasWASMLocation()
+			? loadWASMFile(binary.name).catch((err) => {
+					// fall back to the embedded binary
+					if (!binary.data) {
+						throw err;
+					}
+					return compileEmbeddedModule(binary);
+				})
+			: compileEmbeddedModule(binary);
+
+		const promise = source.then(
+			(module) => {
+				compiledModules.set(binary.name, module);
+				return module;
+			},
+			(err) => {
+				// allow retrying after a failed download
+				wasmModuleCache.delete(binary.name);
+				throw err;
+			},
+		);
+
+		wasmModuleCache.set(binary.name, promise);
+	}
+
+	return wasmModuleCache.get(binary.name);
+}
+
+function compileModuleSync(binary: IEmbeddedWasm): WebAssembly.Module {
+	let module = compiledModules.get(binary.name);
+	if (module === undefined) {
+		if (!binary.data) {
+			throw new Error(
+				`The ${binary.name} binary is not embedded into this build. Call preload() before the synchronous functions`,
+			);
+		}
+
+		module = new WebAssembly.Module(decodeBase64(binary.data));
+		compiledModules.set(binary.name, module);
+		wasmModuleCache.set(binary.name, Promise.resolve(module));
+	}
+
+	return module;
+}
+
+/**
+ * Compiles the WASM module ahead of time, so later instances
+ * (including the synchronous ones) don't have to wait for it
+ */
+export async function preloadWASM(binary: IEmbeddedWasm): Promise<void> {
+	checkWebAssemblySupport();
+	await compileModule(binary);
+}
+
+/**
+ * HMAC implemented inside the WASM module of the underlying hash function
+ * (Hmac_* exports). A module stores the padded key states of a single HMAC
+ * instance, which is tracked by the owner field.
+ */
+export interface INativeHmac {
+	owner: unknown;
+	/**
+	 * Computes the padded key states and starts a new message
+	 * @param key Key, which cannot be longer than the block size
+	 */
+	init: (key: Uint8Array, blockSize: number, owner: unknown) => void;
+	/**
+	 * Starts a new message with the same key
+	 */
+	reset: () => void;
+	digest: (outputType: IDigestOutputType) => Uint8Array | string;
+	digestInto: (target: Uint8Array, offset?: number) => number;
+	hashMany: (
+		owner: IHasher,
+		messages: IDataType[],
+		outputType: "hex" | "binary",
+	) => Uint8Array | string[];
+	/**
+	 * Derives a key with PBKDF2 using the current HMAC key as the password
+	 * @returns Derived key or null if the module cannot calculate it
+	 */
+	pbkdf2: (salt: Uint8Array, iterations: number, length: number) => Uint8Array;
+}
+
+const nativeHmacs = new WeakMap<IHasher, INativeHmac>();
+
+/**
+ * Returns the native HMAC implementation of a hasher, or null if the
+ * hasher does not support it
+ */
+export function getNativeHmac(hasher: IHasher): INativeHmac {
+	return nativeHmacs.get(hasher) ?? null;
+}
+
+// pointers and sizes of memory64 modules are passed as BigInts
+// biome-ignore lint/suspicious/noExplicitAny: BigInt is not in the configured libs
+const toBigInt: (value: number) => unknown = (globalThis as any).BigInt;
+
+function createInterface(
+	binary: IEmbeddedWasm,
+	instance: WebAssembly.Instance,
+	hashLength: number,
+	pooled = false,
+	host: IContextHost = null,
+) {
+	// biome-ignore lint/suspicious/noExplicitAny: the exports are not typed
+	const wasmInstance: any = instance;
+	let memoryView: Uint8Array = null;
+	let initialized = false;
+	let released = false;
+	let contextId = 0;
+
+	const checkReleased = () => {
+		if (released) {
+			throw new Error("The hasher was released");
+		}
+	};
+
+	// selects the context of a multiplexed hasher before accessing the module
+	const activate = () => {
+		if (host === null) {
+			return;
+		}
+
+		// allocating contexts can grow the memory, which detaches the views
+		if (memoryView.buffer !== wasmInstance.exports.memory.buffer) {
+			setupInterface();
+		}
+
+		if (host.current !== contextId) {
+			wasmInstance.exports.Hash_SelectContext(contextId);
+			host.current = contextId;
+		}
+	};
 
 	const writeMemory = (data: Uint8Array, offset = 0) => {
+		activate();
 		memoryView.set(data, offset);
 	};
 
@@ -82,8 +299,11 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 	const getExports = () => wasmInstance.exports;
 
 	const setMemorySize = (totalSize: number) => {
-		wasmInstance.exports.Hash_SetMemorySize(totalSize);
-		const arrayOffset: number = wasmInstance.exports.Hash_GetBuffer();
+		const size = binary.memory64 ? toBigInt(totalSize) : totalSize;
+		if (wasmInstance.exports.Hash_SetMemorySize(size) === -1) {
+			throw new Error(`Cannot allocate ${totalSize} bytes of memory`);
+		}
+		const arrayOffset = Number(wasmInstance.exports.Hash_GetBuffer());
 		const memoryBuffer = wasmInstance.exports.memory.buffer;
 		memoryView = new Uint8Array(memoryBuffer, arrayOffset, totalSize);
 	};
@@ -94,44 +314,15 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 		return stateSize;
 	};
 
-	const loadWASMPromise = wasmMutex.dispatch(async () => {
-		if (!wasmModuleCache.has(binary.name)) {
-			const asm = decodeBase64(binary.data);
-			const promise = WebAssembly.compile(asm);
-
-			wasmModuleCache.set(binary.name, promise);
-		}
-
-		const module = await wasmModuleCache.get(binary.name);
-		wasmInstance = await WebAssembly.instantiate(module, {
-			// env: {
-			//   emscripten_memcpy_big: (dest, src, num) => {
-			//     const memoryBuffer = wasmInstance.exports.memory.buffer;
-			//     const memView = new Uint8Array(memoryBuffer, 0);
-			//     memView.set(memView.subarray(src, src + num), dest);
-			//   },
-			//   print_memory: (offset, len) => {
-			//     const memoryBuffer = wasmInstance.exports.memory.buffer;
-			//     const memView = new Uint8Array(memoryBuffer, 0);
-			//     console.log('print_int32', memView.subarray(offset, offset + len));
-			//   },
-			// },
-		});
-
-		// wasmInstance.exports._start();
-	});
-
-	const setupInterface = async () => {
-		if (!wasmInstance) {
-			await loadWASMPromise;
-		}
-
-		const arrayOffset: number = wasmInstance.exports.Hash_GetBuffer();
+	const setupInterface = () => {
+		const arrayOffset = Number(wasmInstance.exports.Hash_GetBuffer());
 		const memoryBuffer = wasmInstance.exports.memory.buffer;
 		memoryView = new Uint8Array(memoryBuffer, arrayOffset, MAX_HEAP);
 	};
 
 	const init = (bits: number = null) => {
+		checkReleased();
+		activate();
 		initialized = true;
 		wasmInstance.exports.Hash_Init(bits);
 	};
@@ -146,33 +337,139 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 		}
 	};
 
+	const updateString = (data: string): void => {
+		// encodeInto() only writes complete characters, so surrogate pairs
+		// are never split between two chunks
+		let read = 0;
+		while (read < data.length) {
+			const result = encodeStringInto(data.substring(read), memoryView);
+			read += result.read;
+			wasmInstance.exports.Hash_Update(result.written);
+		}
+	};
+
 	const update = (data: IDataType) => {
 		if (!initialized) {
 			throw new Error("update() called before init()");
 		}
+		activate();
+
+		if (typeof data === "string" && encodeStringInto !== null) {
+			updateString(data);
+			return;
+		}
+
 		const Uint8Buffer = getUInt8Buffer(data);
 		updateUInt8Array(Uint8Buffer);
 	};
 
 	const digestChars = new Uint8Array(hashLength * 2);
+	// the encoded digest is written by WASM right after the binary one
+	let canEncodeInWASM = false;
+
+	// the shorthand functions of the modules with multiple variants pass the
+	// digest length of the current call, so one instance serves all variants
+	const getDigestText = (
+		outputType: IDigestOutputType,
+		length = hashLength,
+	): string => {
+		let format = DIGEST_FORMAT_HEX;
+		if (outputType === "base64") {
+			format = DIGEST_FORMAT_BASE64;
+		} else if (outputType === "base64url") {
+			format = DIGEST_FORMAT_BASE64URL;
+		}
+
+		if (canEncodeInWASM && length * 3 <= MAX_HEAP) {
+			const textLength: number = wasmInstance.exports.Hash_EncodeDigest(
+				length,
+				format,
+			);
+			return decodeLatin1(memoryView.subarray(length, length + textLength));
+		}
+
+		if (format === DIGEST_FORMAT_HEX) {
+			const chars =
+				length === hashLength ? digestChars : new Uint8Array(length * 2);
+			return getDigestHex(chars, memoryView, length);
+		}
+
+		const base64 = encodeBase64(
+			memoryView.subarray(0, length),
+			format === DIGEST_FORMAT_BASE64,
+		);
+		return format === DIGEST_FORMAT_BASE64
+			? base64
+			: base64.replace(/\+/g, "-").replace(/\//g, "_");
+	};
+
+	const readDigest = (
+		outputType: IDigestOutputType,
+		length = hashLength,
+	): Uint8Array | string => {
+		if (outputType === "binary") {
+			// the data is copied to allow GC of the original memory object
+			return memoryView.slice(0, length);
+		}
+
+		return getDigestText(outputType, length);
+	};
+
+	const validateDigestTarget = (target: Uint8Array, offset: number) => {
+		if (!(target instanceof Uint8Array)) {
+			throw new Error("digestInto() expects an Uint8Array");
+		}
+
+		if (
+			!Number.isInteger(offset) ||
+			offset < 0 ||
+			offset + hashLength > target.length
+		) {
+			throw new Error(
+				`digestInto() needs ${hashLength} bytes in the target buffer at the given offset`,
+			);
+		}
+	};
+
+	const copyDigest = (target: Uint8Array, offset: number): number => {
+		for (let i = 0; i < hashLength; i++) {
+			target[offset + i] = memoryView[i];
+		}
+
+		return hashLength;
+	};
 
 	const digest = (
-		outputType: "hex" | "binary",
+		outputType: IDigestOutputType,
 		padding: number = null,
+		length = hashLength,
 	): Uint8Array | string => {
 		if (!initialized) {
 			throw new Error("digest() called before init()");
 		}
+		activate();
 		initialized = false;
 
 		wasmInstance.exports.Hash_Final(padding);
 
-		if (outputType === "binary") {
-			// the data is copied to allow GC of the original memory object
-			return memoryView.slice(0, hashLength);
+		return readDigest(outputType, length);
+	};
+
+	const digestInto = (
+		target: Uint8Array,
+		offset = 0,
+		padding: number = null,
+	): number => {
+		if (!initialized) {
+			throw new Error("digestInto() called before init()");
 		}
 
-		return getDigestHex(digestChars, memoryView, hashLength);
+		validateDigestTarget(target, offset);
+		activate();
+		initialized = false;
+		wasmInstance.exports.Hash_Final(padding);
+
+		return copyDigest(target, offset);
 	};
 
 	const save = (): Uint8Array => {
@@ -181,6 +478,7 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 				"save() can only be called after init() and before digest()",
 			);
 		}
+		activate();
 
 		const stateOffset: number = wasmInstance.exports.Hash_GetState();
 		const stateLength: number = getStateSize();
@@ -203,6 +501,8 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 		if (!(state instanceof Uint8Array)) {
 			throw new Error("load() expects an Uint8Array generated by save()");
 		}
+		checkReleased();
+		activate();
 
 		const stateOffset: number = wasmInstance.exports.Hash_GetState();
 		const stateLength: number = getStateSize();
@@ -245,7 +545,9 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 
 	switch (binary.name) {
 		case "argon2":
+		case "argon2_64":
 		case "scrypt":
+		case "scrypt_64":
 			canSimplify = () => true;
 			break;
 
@@ -256,8 +558,10 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 			break;
 
 		case "blake3":
-			// if there is a key at blake3 then cannot simplify
-			canSimplify = (data, initParam) => initParam === 0 && isDataShort(data);
+			// if there is a key at blake3 then cannot simplify,
+			// the derive_key contexts (initParam >= 256) are stored in WASM
+			canSimplify = (data, initParam) =>
+				(initParam === 0 || initParam >= 256) && isDataShort(data);
 			break;
 
 		case "xxhash64": // cannot simplify
@@ -276,23 +580,254 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 		data: IDataType,
 		initParam = null,
 		digestParam = null,
+		length = hashLength,
 	): string => {
 		if (!canSimplify(data, initParam)) {
 			init(initParam);
 			update(data);
-			return digest("hex", digestParam) as string;
+			return digest("hex", digestParam, length) as string;
+		}
+
+		let dataLength: number;
+		if (typeof data === "string" && encodeStringInto !== null) {
+			// short strings always fit into the buffer
+			dataLength = encodeStringInto(data, memoryView).written;
+		} else {
+			const buffer = getUInt8Buffer(data);
+			memoryView.set(buffer);
+			dataLength = buffer.length;
+		}
+
+		wasmInstance.exports.Hash_Calculate(dataLength, initParam, digestParam);
+
+		return getDigestText("hex", length);
+	};
+
+	// writes the message into the batch buffer, returns -1 if it doesn't fit
+	const writeBatchMessage = (
+		data: IDataType,
+		offset: number,
+		space: number,
+	): number => {
+		if (typeof data === "string" && encodeStringInto !== null) {
+			// every UTF-16 code unit takes at least one byte
+			if (data.length > space) {
+				return -1;
+			}
+			const target = memoryView.subarray(offset, offset + space);
+			const result = encodeStringInto(data, target);
+			return result.read < data.length ? -1 : result.written;
 		}
 
 		const buffer = getUInt8Buffer(data);
-		memoryView.set(buffer);
-		wasmInstance.exports.Hash_Calculate(buffer.length, initParam, digestParam);
+		if (buffer.length > space) {
+			return -1;
+		}
+		memoryView.set(buffer, offset);
+		return buffer.length;
+	};
+
+	// hashBatch(count) hashes the messages written by writeBatchMessage()
+	const hashInBatches = (
+		hasher: IHasher,
+		messages: IDataType[],
+		outputType: "hex" | "binary",
+		hashBatch: (count: number) => void,
+	): Uint8Array | string[] => {
+		if (!Array.isArray(messages)) {
+			throw new Error("hashMany() expects an array of messages");
+		}
+
+		const result = new Uint8Array(messages.length * hashLength);
+		const canBatch =
+			hashBatch !== null && hashLength <= BATCH_MAX_MESSAGE_LENGTH;
+		const lengthsView = new DataView(
+			memoryView.buffer,
+			memoryView.byteOffset + BATCH_LENGTHS_OFFSET,
+			BATCH_MAX_COUNT * 4,
+		);
+
+		let index = 0;
+		while (index < messages.length) {
+			const first = index;
+			let dataEnd = BATCH_DATA_OFFSET;
+
+			while (
+				canBatch &&
+				index < messages.length &&
+				index - first < BATCH_MAX_COUNT
+			) {
+				// keep space for the digests after the messages
+				const space = Math.min(
+					MAX_HEAP - dataEnd - (index - first + 1) * hashLength,
+					BATCH_MAX_MESSAGE_LENGTH,
+				);
+				const length = writeBatchMessage(messages[index], dataEnd, space);
+				if (length < 0) {
+					break;
+				}
+
+				lengthsView.setUint32((index - first) * 4, length, true);
+				dataEnd += length;
+				index++;
+			}
+
+			const count = index - first;
+			if (count === 0) {
+				// long messages (or unsupported parameters) are hashed one by one
+				hasher.init();
+				hasher.update(messages[index]);
+				hasher.digestInto(result, index * hashLength);
+				index++;
+				continue;
+			}
+
+			hashBatch(count);
+			result.set(
+				memoryView.subarray(dataEnd, dataEnd + count * hashLength),
+				first * hashLength,
+			);
+		}
+
+		initialized = false;
+
+		if (outputType === "binary") {
+			return result;
+		}
+
+		const hashes: string[] = new Array(messages.length);
+		for (let i = 0; i < messages.length; i++) {
+			hashes[i] = getDigestHex(digestChars, result, hashLength, i * hashLength);
+		}
+		return hashes;
+	};
+
+	const calculateMany = (
+		hasher: IHasher,
+		messages: IDataType[],
+		outputType: "hex" | "binary",
+		initParam = null,
+		digestParam = null,
+	): Uint8Array | string[] => {
+		checkReleased();
+		activate();
+		const canBatch =
+			typeof wasmInstance.exports.Hash_CalculateMany === "function" &&
+			canSimplify("", initParam);
+
+		return hashInBatches(
+			hasher,
+			messages,
+			outputType,
+			canBatch
+				? (count) =>
+						wasmInstance.exports.Hash_CalculateMany(
+							count,
+							hashLength,
+							initParam,
+							digestParam,
+						)
+				: null,
+		);
+	};
+
+	const registerNativeHmac = (
+		hasher: IHasher,
+		initParam = null,
+		digestParam = null,
+	) => {
+		const { exports } = wasmInstance;
+		// the module stores a single pair of HMAC key states,
+		// multiplexed hashers fall back to the generic HMAC
+		if (typeof exports.Hmac_Init !== "function" || host !== null) {
+			return;
+		}
+
+		const native: INativeHmac = {
+			owner: null,
+			init: (key, blockSize, owner) => {
+				checkReleased();
+				writeMemory(key);
+				exports.Hmac_Init(
+					key.length,
+					blockSize,
+					hashLength,
+					initParam,
+					digestParam,
+				);
+				native.owner = owner;
+				initialized = true;
+			},
+			reset: () => {
+				checkReleased();
+				exports.Hmac_Reset();
+				initialized = true;
+			},
+			digest: (outputType) => {
+				if (!initialized) {
+					throw new Error("digest() called before init()");
+				}
+				initialized = false;
+				exports.Hmac_Final();
+				return readDigest(outputType);
+			},
+			digestInto: (target, offset = 0) => {
+				if (!initialized) {
+					throw new Error("digestInto() called before init()");
+				}
+
+				validateDigestTarget(target, offset);
+				initialized = false;
+				exports.Hmac_Final();
+				return copyDigest(target, offset);
+			},
+			hashMany: (owner, messages, outputType) => {
+				checkReleased();
+				return hashInBatches(owner, messages, outputType, (count) =>
+					exports.Hmac_CalculateMany(count, hashLength),
+				);
+			},
+			pbkdf2: (salt, iterations, length) => {
+				checkReleased();
+				const blocks = Math.ceil(length / hashLength);
+				const saltOffset = Math.max(PBKDF2_SALT_OFFSET, salt.length + 4);
+				if (
+					typeof exports.Pbkdf2_Calculate !== "function" ||
+					saltOffset + salt.length + blocks * hashLength > MAX_HEAP
+				) {
+					return null;
+				}
+
+				writeMemory(salt, saltOffset);
+				exports.Pbkdf2_Calculate(salt.length, iterations, length);
+				initialized = false;
+				return memoryView.slice(0, length);
+			},
+		};
+
+		nativeHmacs.set(hasher, native);
+	};
+
+	const release = () => {
+		if (released) {
+			return;
+		}
 
-		return getDigestHex(digestChars, memoryView, hashLength);
+		released = true;
+		initialized = false;
+		if (pooled) {
+			releaseInstance(wasmInterface, binary.name, instance);
+		}
+		if (host !== null) {
+			destroyContext(wasmInterface, host, contextId);
+		}
 	};
 
-	await setupInterface();
+	setupInterface();
+	canEncodeInWASM =
+		typeof wasmInstance.exports.Hash_EncodeDigest === "function";
 
-	return {
+	const wasmInterface = {
 		getMemory,
 		writeMemory,
 		getExports,
@@ -300,11 +835,110 @@ export async function WASMInterface(binary: IEmbeddedWasm, hashLength: number) {
 		init,
 		update,
 		digest,
+		digestInto,
 		save,
 		load,
 		calculate,
+		calculateMany,
+		registerNativeHmac,
+		release,
 		hashLength,
 	};
+
+	if (pooled) {
+		trackInstance(wasmInterface, binary.name, instance);
+	}
+
+	if (host !== null) {
+		contextId = createContext(wasmInterface, host);
+		activate();
+	}
+
+	return wasmInterface;
+}
+
+export async function WASMInterface(
+	binary: IEmbeddedWasm,
+	hashLength: number,
+	options?: IHasherOptions,
+): Promise<IWASMInterface> {
+	checkWebAssemblySupport();
+
+	if (options?.multiplexed === true) {
+		let host = getContextHost(binary.name);
+		if (host === null) {
+			// the host is not a shared memory instance, it has to grow the memory
+			const module = await compileModule(binary);
+			const instance = await WebAssembly.instantiate(module, {});
+			host = addContextHost(binary.name, instance);
+		}
+		return createInterface(binary, host.instance, hashLength, false, host);
+	}
+
+	const pooled = options?.pooled === true;
+	const pooledInstance = pooled ? takeInstance(binary.name) : null;
+	if (pooledInstance !== null) {
+		return createInterface(binary, pooledInstance, hashLength, true);
+	}
+
+	const sharedInstance = await instantiateShared(binary.name);
+	if (sharedInstance !== null) {
+		return createInterface(binary, sharedInstance, hashLength, pooled);
+	}
+
+	// the compilation is shared by the instances of the same module,
+	// different modules are compiled in parallel
+	const module = await compileModule(binary);
+	const instance = await WebAssembly.instantiate(module, {
+		// env: {
+		//   emscripten_memcpy_big: (dest, src, num) => {
+		//     const memoryBuffer = wasmInstance.exports.memory.buffer;
+		//     const memView = new Uint8Array(memoryBuffer, 0);
+		//     memView.set(memView.subarray(src, src + num), dest);
+		//   },
+		//   print_memory: (offset, len) => {
+		//     const memoryBuffer = wasmInstance.exports.memory.buffer;
+		//     const memView = new Uint8Array(memoryBuffer, 0);
+		//     console.log('print_int32', memView.subarray(offset, offset + len));
+		//   },
+		// },
+	});
+
+	return createInterface(binary, instance, hashLength, pooled);
+}
+
+/**
+ * Synchronous version of WASMInterface(). The module is compiled
+ * synchronously, unless it was already compiled or preloaded.
+ * Browsers can refuse the synchronous compilation of larger modules
+ * on the main thread.
+ */
+export function WASMInterfaceSync(
+	binary: IEmbeddedWasm,
+	hashLength: number,
+	options?: IHasherOptions,
+): IWASMInterface {
+	checkWebAssemblySupport();
+
+	if (options?.multiplexed === true) {
+		let host = getContextHost(binary.name);
+		if (host === null) {
+			const module = compileModuleSync(binary);
+			const instance = new WebAssembly.Instance(module, {});
+			host = addContextHost(binary.name, instance);
+		}
+		return createInterface(binary, host.instance, hashLength, false, host);
+	}
+
+	const pooled = options?.pooled === true;
+	const pooledInstance = pooled ? takeInstance(binary.name) : null;
+	if (pooledInstance !== null) {
+		return createInterface(binary, pooledInstance, hashLength, true);
+	}
+
+	const module = compileModuleSync(binary);
+	const instance = new WebAssembly.Instance(module, {});
+	return createInterface(binary, instance, hashLength, pooled);
 }
 
-export type IWASMInterface = ThenArg<ReturnType<typeof WASMInterface>>;
+export type IWASMInterface = ReturnType<typeof createInterface>;
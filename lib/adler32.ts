@@ -1,14 +1,19 @@
 import wasmJson from "../wasm/adler32.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
-import type { IDataType } from "./util";
+import sharedCreate from "./sharedCreate";
+import {
+	type IDataType,
+	getDigestHex,
+	isHexString,
+	writeHexToUInt8,
+} from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
 /**
@@ -20,7 +25,7 @@ let wasmCache: IWASMInterface = null;
  */
 export function adler32(data: IDataType): Promise<string> {
 	if (wasmCache === null) {
-		return lockedCreate(mutex, wasmJson, 4).then((wasm) => {
+		return sharedCreate(wasmJson, 4).then((wasm) => {
 			wasmCache = wasm;
 			return wasmCache.calculate(data);
 		});
@@ -34,31 +39,98 @@ export function adler32(data: IDataType): Promise<string> {
 	}
 }
 
+/**
+ * Combines the Adler-32 checksums of two consecutive parts of the data into
+ * the checksum of the whole data, without accessing the data.
+ * Same as zlib's adler32_combine()
+ * @param adler1 Checksum of the first part as a hexadecimal string
+ * @param adler2 Checksum of the second part as a hexadecimal string
+ * @param length2 Length of the second part in bytes
+ * @returns Combined checksum as a hexadecimal string
+ */
+export function adler32Combine(
+	adler1: string,
+	adler2: string,
+	length2: number,
+): Promise<string> {
+	if (!isHexString(adler1, 4) || !isHexString(adler2, 4)) {
+		return Promise.reject(
+			new Error("Checksums must be 8 char long hex strings"),
+		);
+	}
+
+	if (!Number.isSafeInteger(length2) || length2 < 0) {
+		return Promise.reject(new Error("Length must be a non-negative integer"));
+	}
+
+	const combine = () => {
+		const checksums = new Uint8Array(8);
+		writeHexToUInt8(checksums, adler1 + adler2);
+		wasmCache.writeMemory(checksums);
+		wasmCache
+			.getExports()
+			.Hash_Combine(length2 % 0x100000000, Math.floor(length2 / 0x100000000));
+		return getDigestHex(new Uint8Array(8), wasmCache.getMemory(), 4);
+	};
+
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 4).then((wasm) => {
+			wasmCache = wasm;
+			return combine();
+		});
+	}
+
+	try {
+		return Promise.resolve(combine());
+	} catch (err) {
+		return Promise.reject(err);
+	}
+}
+
+function createHasher(wasm: IWASMInterface): IHasher {
+	wasm.init();
+	const obj: IHasher = {
+		init: () => {
+			wasm.init();
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 4,
+		digestSize: 4,
+	};
+	return obj;
+}
+
 /**
  * Creates a new Adler-32 hash instance
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createAdler32(options?: IHasherOptions): Promise<IHasher> {
+	return WASMInterface(wasmJson, 4, options).then(createHasher);
+}
+
+/**
+ * Creates a new Adler-32 hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createAdler32(): Promise<IHasher> {
-	return WASMInterface(wasmJson, 4).then((wasm) => {
-		wasm.init();
-		const obj: IHasher = {
-			init: () => {
-				wasm.init();
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 4,
-			digestSize: 4,
-		};
-		return obj;
-	});
+export function createAdler32Sync(options?: IHasherOptions): IHasher {
+	return createHasher(WASMInterfaceSync(wasmJson, 4, options));
 }
@@ -1,6 +1,11 @@
 import wasmJson from "../wasm/argon2.wasm.json";
-import { type IHasher, WASMInterface } from "./WASMInterface";
-import { createBLAKE2b } from "./blake2b";
+import wasm64Json from "../wasm/argon2_64.wasm.json";
+import { type IWASMInterface, WASMInterface } from "./WASMInterface";
+import {
+	type IKDFEngineOptions,
+	createKDFEngine,
+	selectKDFBinary,
+} from "./kdfEngine";
 import {
 	type IDataType,
 	decodeBase64,
@@ -8,7 +13,6 @@ import {
 	getDecodeBase64Length,
 	getDigestHex,
 	getUInt8Buffer,
-	writeHexToUInt8,
 } from "./util";
 
 export interface IArgon2Options {
@@ -67,57 +71,6 @@ function encodeResult(
 	)}$${encodeBase64(res, false)}`;
 }
 
-const uint32View = new DataView(new ArrayBuffer(4));
-function int32LE(x: number): Uint8Array {
-	uint32View.setInt32(0, x, true);
-	return new Uint8Array(uint32View.buffer);
-}
-
-async function hashFunc(
-	blake512: IHasher,
-	buf: Uint8Array,
-	len: number,
-): Promise<Uint8Array> {
-	if (len <= 64) {
-		const blake = await createBLAKE2b(len * 8);
-		blake.update(int32LE(len));
-		blake.update(buf);
-		return blake.digest("binary");
-	}
-
-	const r = Math.ceil(len / 32) - 2;
-	const ret = new Uint8Array(len);
-
-	blake512.init();
-	blake512.update(int32LE(len));
-	blake512.update(buf);
-	let vp = blake512.digest("binary");
-	ret.set(vp.subarray(0, 32), 0);
-
-	for (let i = 1; i < r; i++) {
-		blake512.init();
-		blake512.update(vp);
-		vp = blake512.digest("binary");
-		ret.set(vp.subarray(0, 32), i * 32);
-	}
-
-	const partialBytesNeeded = len - 32 * r;
-
-	let blakeSmall: IHasher;
-	if (partialBytesNeeded === 64) {
-		blakeSmall = blake512;
-		blakeSmall.init();
-	} else {
-		blakeSmall = await createBLAKE2b(partialBytesNeeded * 8);
-	}
-
-	blakeSmall.update(vp);
-	vp = blakeSmall.digest("binary");
-	ret.set(vp.subarray(0, partialBytesNeeded), r * 32);
-
-	return ret;
-}
-
 function getHashType(type: IArgon2OptionsExtended["hashType"]): number {
 	switch (type) {
 		case "d":
@@ -129,9 +82,9 @@ function getHashType(type: IArgon2OptionsExtended["hashType"]): number {
 	}
 }
 
-async function argon2Internal(
-	options: IArgon2OptionsExtended,
-): Promise<string | Uint8Array> {
+// input of H0: the parameters followed by the length-prefixed
+// password, salt, secret and associated data
+function getInput(options: IArgon2OptionsExtended): Uint8Array {
 	const { parallelism, iterations, hashLength } = options;
 	const password = getUInt8Buffer(options.password);
 	const salt = getUInt8Buffer(options.salt);
@@ -140,59 +93,50 @@ async function argon2Internal(
 	const { memorySize } = options; // in KB
 	const secret = getUInt8Buffer(options.secret ?? "");
 
-	const [argon2Interface, blake512] = await Promise.all([
-		WASMInterface(wasmJson, 1024),
-		createBLAKE2b(512),
-	]);
-
-	// last block is for storing the init vector
-	argon2Interface.setMemorySize(memorySize * 1024 + 1024);
-
-	const initVector = new Uint8Array(24);
-	const initVectorView = new DataView(initVector.buffer);
-	initVectorView.setInt32(0, parallelism, true);
-	initVectorView.setInt32(4, hashLength, true);
-	initVectorView.setInt32(8, memorySize, true);
-	initVectorView.setInt32(12, iterations, true);
-	initVectorView.setInt32(16, version, true);
-	initVectorView.setInt32(20, hashType, true);
-	argon2Interface.writeMemory(initVector, memorySize * 1024);
-
-	blake512.init();
-	blake512.update(initVector);
-	blake512.update(int32LE(password.length));
-	blake512.update(password);
-	blake512.update(int32LE(salt.length));
-	blake512.update(salt);
-	blake512.update(int32LE(secret.length));
-	blake512.update(secret);
-	blake512.update(int32LE(0)); // associatedData length + associatedData
-
-	const segments = Math.floor(memorySize / (parallelism * 4)); // length of each lane
-	const lanes = segments * 4;
-
-	const param = new Uint8Array(72);
-	const H0 = blake512.digest("binary");
-	param.set(H0);
-
-	for (let lane = 0; lane < parallelism; lane++) {
-		param.set(int32LE(0), 64);
-		param.set(int32LE(lane), 68);
-
-		let position = lane * lanes;
-		let chunk = await hashFunc(blake512, param, 1024);
-		argon2Interface.writeMemory(chunk, position * 1024);
-
-		position += 1;
-		param.set(int32LE(1), 64);
-		chunk = await hashFunc(blake512, param, 1024);
-		argon2Interface.writeMemory(chunk, position * 1024);
+	const input = new Uint8Array(
+		40 + password.length + salt.length + secret.length,
+	);
+	const inputView = new DataView(input.buffer);
+	inputView.setInt32(0, parallelism, true);
+	inputView.setInt32(4, hashLength, true);
+	inputView.setInt32(8, memorySize, true);
+	inputView.setInt32(12, iterations, true);
+	inputView.setInt32(16, version, true);
+	inputView.setInt32(20, hashType, true);
+
+	let position = 24;
+	for (const field of [password, salt, secret, new Uint8Array(0)]) {
+		inputView.setInt32(position, field.length, true);
+		input.set(field, position + 4);
+		position += 4 + field.length;
 	}
 
-	const C = new Uint8Array(1024);
-	writeHexToUInt8(C, argon2Interface.calculate(new Uint8Array([]), memorySize));
+	return input;
+}
+
+// memory used by the blocks, followed by the input or the tag
+function getMemorySize(
+	options: IArgon2OptionsExtended,
+	input: Uint8Array,
+): number {
+	return options.memorySize * 1024 + Math.max(input.length, options.hashLength);
+}
+
+function calculateArgon2(
+	argon2Interface: IWASMInterface,
+	options: IArgon2OptionsExtended,
+	input: Uint8Array,
+): string | Uint8Array {
+	const { hashLength, memorySize } = options;
+
+	// the input is stored after the memory blocks and
+	// the whole hash is calculated in a single call
+	argon2Interface.setMemorySize(getMemorySize(options, input));
+	argon2Interface.writeMemory(input, memorySize * 1024);
+	argon2Interface.getExports().Hash_Calculate(input.length, memorySize);
 
-	const res = await hashFunc(blake512, C, hashLength);
+	// the tag is written to the start of the memory
+	const res = argon2Interface.getMemory().slice(0, hashLength);
 
 	if (options.outputType === "hex") {
 		const digestChars = new Uint8Array(hashLength * 2);
@@ -200,13 +144,23 @@ async function argon2Internal(
 	}
 
 	if (options.outputType === "encoded") {
-		return encodeResult(salt, options, res);
+		return encodeResult(getUInt8Buffer(options.salt), options, res);
 	}
 
 	// return binary format
 	return res;
 }
 
+async function argon2Internal(
+	options: IArgon2OptionsExtended,
+): Promise<string | Uint8Array> {
+	// memory sizes over 2 GiB use the memory64 build
+	const input = getInput(options);
+	const memorySize = getMemorySize(options, input);
+	const binary = selectKDFBinary(wasmJson, wasm64Json, memorySize);
+	return calculateArgon2(await WASMInterface(binary, 1024), options, input);
+}
+
 const validateOptions = (options: IArgon2Options) => {
 	if (!options || typeof options !== "object") {
 		throw new Error("Invalid options parameter. It requires an object.");
@@ -374,12 +328,9 @@ const validateVerifyOptions = (options: Argon2VerifyOptions) => {
 	}
 };
 
-/**
- * Verifies password using the argon2 password-hashing function
- * @returns True if the encoded hash matches the password
- */
-export async function argon2Verify(
+async function verifyInternal(
 	options: Argon2VerifyOptions,
+	calculate: (params: IArgon2OptionsExtended) => Promise<string | Uint8Array>,
 ): Promise<boolean> {
 	validateVerifyOptions(options);
 
@@ -391,6 +342,79 @@ export async function argon2Verify(
 	validateOptions(params);
 
 	const hashStart = options.hash.lastIndexOf("$") + 1;
-	const result = (await argon2Internal(params)) as string;
+	const result = (await calculate(params)) as string;
 	return result.substring(hashStart) === options.hash.substring(hashStart);
 }
+
+/**
+ * Verifies password using the argon2 password-hashing function
+ * @returns True if the encoded hash matches the password
+ */
+export async function argon2Verify(
+	options: Argon2VerifyOptions,
+): Promise<boolean> {
+	return verifyInternal(options, argon2Internal);
+}
+
+export interface IArgon2Engine {
+	/**
+	 * Calculates hash using the argon2i password-hashing function
+	 */
+	argon2i<T extends IArgon2Options>(options: T): Promise<Argon2ReturnType<T>>;
+	/**
+	 * Calculates hash using the argon2id password-hashing function
+	 */
+	argon2id<T extends IArgon2Options>(options: T): Promise<Argon2ReturnType<T>>;
+	/**
+	 * Calculates hash using the argon2d password-hashing function
+	 */
+	argon2d<T extends IArgon2Options>(options: T): Promise<Argon2ReturnType<T>>;
+	/**
+	 * Verifies password using the argon2 password-hashing function
+	 */
+	argon2Verify(options: Argon2VerifyOptions): Promise<boolean>;
+	/**
+	 * Drops the WebAssembly instance and its memory.
+	 * The engine cannot be used afterwards
+	 */
+	dispose(): void;
+}
+
+/**
+ * Creates an Argon2 engine, which reuses a single WebAssembly instance for
+ * all of its calculations instead of allocating a new memory for each one.
+ * The memory grows to the memory size of the largest calculation and it
+ * is kept until dispose() is called.
+ * @param options maxMemory limits the memory used by a calculation in bytes.
+ *                Calculations with larger memory sizes are rejected
+ */
+export async function createArgon2Engine(
+	options: IKDFEngineOptions = {},
+): Promise<IArgon2Engine> {
+	const engine = await createKDFEngine(wasmJson, wasm64Json, 1024, options);
+
+	const calculate = (params: IArgon2OptionsExtended) => {
+		const input = getInput(params);
+		return engine.run(getMemorySize(params, input), (wasm) =>
+			calculateArgon2(wasm, params, input),
+		);
+	};
+
+	const hash =
+		(hashType: IArgon2OptionsExtended["hashType"]) =>
+		async <T extends IArgon2Options>(
+			options: T,
+		): Promise<Argon2ReturnType<T>> => {
+			validateOptions(options);
+			const params = { ...options, hashType };
+			return calculate(params) as Promise<Argon2ReturnType<T>>;
+		};
+
+	return {
+		argon2i: hash("i"),
+		argon2id: hash("id"),
+		argon2d: hash("d"),
+		argon2Verify: (options) => verifyInternal(options, calculate),
+		dispose: engine.dispose,
+	};
+}
@@ -1,14 +1,14 @@
 import wasmJson from "../wasm/blake2b.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
+import sharedCreate from "./sharedCreate";
 import { type IDataType, getUInt8Buffer } from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
 function validateBits(bits: number) {
@@ -51,13 +51,13 @@ export function blake2b(
 
 	const hashLength = bits / 8;
 
-	if (wasmCache === null || wasmCache.hashLength !== hashLength) {
-		return lockedCreate(mutex, wasmJson, hashLength).then((wasm) => {
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 64).then((wasm) => {
 			wasmCache = wasm;
 			if (initParam > 512) {
 				wasmCache.writeMemory(keyBuffer);
 			}
-			return wasmCache.calculate(data, initParam);
+			return wasmCache.calculate(data, initParam, null, hashLength);
 		});
 	}
 
@@ -65,22 +65,74 @@ export function blake2b(
 		if (initParam > 512) {
 			wasmCache.writeMemory(keyBuffer);
 		}
-		const hash = wasmCache.calculate(data, initParam);
+		const hash = wasmCache.calculate(data, initParam, null, hashLength);
 		return Promise.resolve(hash);
 	} catch (err) {
 		return Promise.reject(err);
 	}
 }
 
+function createHasher(
+	wasm: IWASMInterface,
+	initParam: number,
+	keyBuffer: Uint8Array,
+	outputSize: number,
+): IHasher {
+	if (initParam > 512) {
+		wasm.writeMemory(keyBuffer);
+	}
+	wasm.init(initParam);
+
+	const obj: IHasher = {
+		init:
+			initParam > 512
+				? () => {
+						wasm.writeMemory(keyBuffer);
+						wasm.init(initParam);
+						return obj;
+					}
+				: () => {
+						wasm.init(initParam);
+						return obj;
+					},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType, initParam) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 128,
+		digestSize: outputSize,
+	};
+	if (initParam <= 512) {
+		// keyed variants read the key from the memory on init
+		wasm.registerNativeHmac(obj, initParam);
+	}
+	return obj;
+}
+
 /**
  * Creates a new BLAKE2b hash instance
  * @param bits Number of output bits, which has to be a number
  *             divisible by 8, between 8 and 512. Defaults to 512.
  * @param key Optional key (string, Buffer or TypedArray). Maximum length is 64 bytes.
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
 export function createBLAKE2b(
 	bits = 512,
 	key: IDataType = null,
+	options?: IHasherOptions,
 ): Promise<IHasher> {
 	if (validateBits(bits)) {
 		return Promise.reject(validateBits(bits));
@@ -98,38 +150,45 @@ export function createBLAKE2b(
 
 	const outputSize = bits / 8;
 
-	return WASMInterface(wasmJson, outputSize).then((wasm) => {
-		if (initParam > 512) {
-			wasm.writeMemory(keyBuffer);
+	return WASMInterface(wasmJson, outputSize, options).then((wasm) =>
+		createHasher(wasm, initParam, keyBuffer, outputSize),
+	);
+}
+
+/**
+ * Creates a new BLAKE2b hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param bits Number of output bits, which has to be a number
+ *             divisible by 8, between 8 and 512. Defaults to 512.
+ * @param key Optional key (string, Buffer or TypedArray). Maximum length is 64 bytes.
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createBLAKE2bSync(
+	bits = 512,
+	key: IDataType = null,
+	options?: IHasherOptions,
+): IHasher {
+	if (validateBits(bits)) {
+		throw validateBits(bits);
+	}
+
+	let keyBuffer = null;
+	let initParam = bits;
+	if (key !== null) {
+		keyBuffer = getUInt8Buffer(key);
+		if (keyBuffer.length > 64) {
+			throw new Error("Max key length is 64 bytes");
 		}
-		wasm.init(initParam);
-
-		const obj: IHasher = {
-			init:
-				initParam > 512
-					? () => {
-							wasm.writeMemory(keyBuffer);
-							wasm.init(initParam);
-							return obj;
-						}
-					: () => {
-							wasm.init(initParam);
-							return obj;
-						},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 128,
-			digestSize: outputSize,
-		};
-		return obj;
-	});
+		initParam = getInitParam(bits, keyBuffer.length);
+	}
+
+	const outputSize = bits / 8;
+
+	return createHasher(
+		WASMInterfaceSync(wasmJson, outputSize, options),
+		initParam,
+		keyBuffer,
+		outputSize,
+	);
 }
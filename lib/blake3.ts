@@ -1,16 +1,41 @@
 import wasmJson from "../wasm/blake3.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
+	MAX_HEAP,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
+import sharedCreate from "./sharedCreate";
 import { type IDataType, getUInt8Buffer } from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
+export interface IBLAKE3Reader {
+	/**
+	 * Reads the next bytes of the extendable output
+	 * @param length Number of bytes to read
+	 */
+	read(length: number): Uint8Array;
+	/**
+	 * Moves the reader to a byte position of the output
+	 */
+	seek(position: number): IBLAKE3Reader;
+}
+
+export interface IBLAKE3Hasher extends IHasher {
+	/**
+	 * Returns a reader of the extendable output (XOF) of the data hashed
+	 * so far. The output has no length limit. Updating the hasher
+	 * afterwards does not change the output of the reader
+	 */
+	xof(): IBLAKE3Reader;
+}
+
+// the reader, whose state is stored in the instance
+const activeReaders = new WeakMap<object, IBLAKE3Reader>();
+
 function validateBits(bits: number) {
 	if (!Number.isInteger(bits) || bits < 8 || bits % 8 !== 0) {
 		return new Error("Invalid variant! Valid values: 8, 16, ...");
@@ -48,13 +73,13 @@ export function blake3(
 	const hashLength = bits / 8;
 	const digestParam = hashLength;
 
-	if (wasmCache === null || wasmCache.hashLength !== hashLength) {
-		return lockedCreate(mutex, wasmJson, hashLength).then((wasm) => {
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 32).then((wasm) => {
 			wasmCache = wasm;
 			if (initParam === 32) {
 				wasmCache.writeMemory(keyBuffer);
 			}
-			return wasmCache.calculate(data, initParam, digestParam);
+			return wasmCache.calculate(data, initParam, digestParam, hashLength);
 		});
 	}
 
@@ -62,23 +87,231 @@ export function blake3(
 		if (initParam === 32) {
 			wasmCache.writeMemory(keyBuffer);
 		}
-		const hash = wasmCache.calculate(data, initParam, digestParam);
+		const hash = wasmCache.calculate(data, initParam, digestParam, hashLength);
 		return Promise.resolve(hash);
 	} catch (err) {
 		return Promise.reject(err);
 	}
 }
 
+// has to match DERIVE_KEY_PARAM and DERIVE_KEY_SLOTS in src/blake3.c
+const DERIVE_KEY_PARAM = 256;
+const DERIVE_KEY_SLOTS = 16;
+// slots of the context keys stored in wasmCache, in least recently used order
+const deriveKeyContexts = new Map<string, number>();
+
+function getDeriveKeySlot(wasm: IWASMInterface, context: string): number {
+	let slot = deriveKeyContexts.get(context);
+	if (slot !== undefined) {
+		deriveKeyContexts.delete(context);
+		deriveKeyContexts.set(context, slot);
+		return slot;
+	}
+
+	const contextBuffer = getUInt8Buffer(context);
+	if (contextBuffer.length > MAX_HEAP) {
+		throw new Error(`Context should not be longer than ${MAX_HEAP} bytes`);
+	}
+
+	slot = deriveKeyContexts.size;
+	if (slot === DERIVE_KEY_SLOTS) {
+		const oldest = deriveKeyContexts.keys().next().value;
+		slot = deriveKeyContexts.get(oldest);
+		deriveKeyContexts.delete(oldest);
+	}
+
+	// the context key is hashed once and kept inside the instance
+	wasm.writeMemory(contextBuffer);
+	wasm.getExports().Hash_SetDeriveKeyContext(slot, contextBuffer.length);
+	deriveKeyContexts.set(context, slot);
+	return slot;
+}
+
+/**
+ * Derives a key using the derive_key mode of BLAKE3. The context keys of
+ * the recently used contexts are cached, so the derivations with the
+ * same context only hash the key material.
+ * @param context Hardcoded, globally unique, application-specific string
+ * @param material Key material (string, Buffer or TypedArray)
+ * @param bits Number of output bits, which has to be a number
+ *             divisible by 8. Defaults to 256.
+ * @returns Derived key as a hexadecimal string
+ */
+export function blake3DeriveKey(
+	context: string,
+	material: IDataType,
+	bits = 256,
+): Promise<string> {
+	if (typeof context !== "string") {
+		return Promise.reject(new Error("Context should be a string"));
+	}
+
+	if (validateBits(bits)) {
+		return Promise.reject(validateBits(bits));
+	}
+
+	const hashLength = bits / 8;
+
+	const derive = () => {
+		const slot = getDeriveKeySlot(wasmCache, context);
+		const initParam = DERIVE_KEY_PARAM + slot;
+		return wasmCache.calculate(material, initParam, hashLength, hashLength);
+	};
+
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 32).then((wasm) => {
+			wasmCache = wasm;
+			return derive();
+		});
+	}
+
+	try {
+		return Promise.resolve(derive());
+	} catch (err) {
+		return Promise.reject(err);
+	}
+}
+
+// the reader cannot be used after its hasher was released,
+// because the instance could be reused by a pooled hasher
+function createReader(
+	wasm: IWASMInterface,
+	isReleased: () => boolean,
+): IBLAKE3Reader {
+	const exports = wasm.getExports();
+	const stateLength: number = exports.Hash_StartXOF();
+	const stateOffset: number = exports.Hash_GetXOFState();
+	const state = new Uint8Array(
+		exports.memory.buffer,
+		stateOffset,
+		stateLength,
+	).slice();
+	let position = 0;
+
+	const reader: IBLAKE3Reader = {
+		read: (length) => {
+			if (isReleased()) {
+				throw new Error("The hasher was released");
+			}
+			if (!Number.isInteger(length) || length < 0) {
+				throw new Error("Length should be a non-negative integer");
+			}
+
+			// another reader of the instance could have replaced the state
+			if (activeReaders.get(exports) !== reader) {
+				const memoryBuffer = exports.memory.buffer;
+				new Uint8Array(memoryBuffer, stateOffset, stateLength).set(state);
+				activeReaders.set(exports, reader);
+			}
+
+			const output = new Uint8Array(length);
+			const memory = wasm.getMemory();
+			for (let read = 0; read < length; read += MAX_HEAP) {
+				const chunkLength = Math.min(length - read, MAX_HEAP);
+				exports.Hash_Squeeze(
+					position % 0x100000000,
+					Math.floor(position / 0x100000000),
+					chunkLength,
+				);
+				output.set(memory.subarray(0, chunkLength), read);
+				position += chunkLength;
+			}
+			return output;
+		},
+		seek: (offset) => {
+			if (isReleased()) {
+				throw new Error("The hasher was released");
+			}
+			if (!Number.isSafeInteger(offset) || offset < 0) {
+				throw new Error("Position should be a non-negative integer");
+			}
+			position = offset;
+			return reader;
+		},
+	};
+
+	activeReaders.set(exports, reader);
+	return reader;
+}
+
+function createHasher(
+	wasm: IWASMInterface,
+	initParam: number,
+	keyBuffer: Uint8Array,
+	outputSize: number,
+): IBLAKE3Hasher {
+	let released = false;
+
+	const digestParam = outputSize;
+
+	if (initParam === 32) {
+		wasm.writeMemory(keyBuffer);
+	}
+	wasm.init(initParam);
+
+	const obj: IBLAKE3Hasher = {
+		init:
+			initParam === 32
+				? () => {
+						wasm.writeMemory(keyBuffer);
+						wasm.init(initParam);
+						return obj;
+					}
+				: () => {
+						wasm.init(initParam);
+						return obj;
+					},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType, digestParam) as any,
+		digestInto: (target, offset) =>
+			wasm.digestInto(target, offset, digestParam),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(
+				obj,
+				messages,
+				outputType,
+				initParam,
+				digestParam,
+			) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		xof: () => {
+			if (released) {
+				throw new Error("The hasher was released");
+			}
+			return createReader(wasm, () => released);
+		},
+		release: () => {
+			released = true;
+			wasm.release();
+		},
+		blockSize: 64,
+		digestSize: outputSize,
+	};
+	return obj;
+}
+
 /**
  * Creates a new BLAKE3 hash instance
  * @param bits Number of output bits, which has to be a number
  *             divisible by 8. Defaults to 256.
  * @param key Optional key (string, Buffer or TypedArray). Length should be 32 bytes.
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
 export function createBLAKE3(
 	bits = 256,
 	key: IDataType = null,
-): Promise<IHasher> {
+	options?: IHasherOptions,
+): Promise<IBLAKE3Hasher> {
 	if (validateBits(bits)) {
 		return Promise.reject(validateBits(bits));
 	}
@@ -94,40 +327,46 @@ export function createBLAKE3(
 	}
 
 	const outputSize = bits / 8;
-	const digestParam = outputSize;
 
-	return WASMInterface(wasmJson, outputSize).then((wasm) => {
-		if (initParam === 32) {
-			wasm.writeMemory(keyBuffer);
+	return WASMInterface(wasmJson, outputSize, options).then((wasm) =>
+		createHasher(wasm, initParam, keyBuffer, outputSize),
+	);
+}
+
+/**
+ * Creates a new BLAKE3 hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param bits Number of output bits, which has to be a number
+ *             divisible by 8. Defaults to 256.
+ * @param key Optional key (string, Buffer or TypedArray). Length should be 32 bytes.
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createBLAKE3Sync(
+	bits = 256,
+	key: IDataType = null,
+	options?: IHasherOptions,
+): IBLAKE3Hasher {
+	if (validateBits(bits)) {
+		throw validateBits(bits);
+	}
+
+	let keyBuffer = null;
+	let initParam = 0; // key is empty by default
+	if (key !== null) {
+		keyBuffer = getUInt8Buffer(key);
+		if (keyBuffer.length !== 32) {
+			throw new Error("Key length must be exactly 32 bytes");
 		}
-		wasm.init(initParam);
-
-		const obj: IHasher = {
-			init:
-				initParam === 32
-					? () => {
-							wasm.writeMemory(keyBuffer);
-							wasm.init(initParam);
-							return obj;
-						}
-					: () => {
-							wasm.init(initParam);
-							return obj;
-						},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType, digestParam) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 64,
-			digestSize: outputSize,
-		};
-		return obj;
-	});
+		initParam = 32;
+	}
+
+	const outputSize = bits / 8;
+
+	return createHasher(
+		WASMInterfaceSync(wasmJson, outputSize, options),
+		initParam,
+		keyBuffer,
+		outputSize,
+	);
 }
@@ -0,0 +1,431 @@
+import wasmJson from "../wasm/blake3.wasm.json";
+import { type IWASMInterface, MAX_HEAP } from "./WASMInterface";
+import sharedCreate from "./sharedCreate";
+import { type IDataType, getDigestHex, getUInt8Buffer } from "./util";
+
+const CHUNK_LEN = 1024;
+const CV_LEN = 32;
+const PARENT_LEN = 64;
+// the outboard starts with the content length as a 64-bit LE number
+const HEADER_LEN = 8;
+
+let wasmCache: IWASMInterface = null;
+
+export interface IBLAKE3Outboard {
+	/**
+	 * BLAKE3 hash of the data as a hexadecimal string
+	 */
+	hash: string;
+	/**
+	 * Content length and the parent nodes of the tree in pre-order
+	 * (Bao outboard format)
+	 */
+	outboard: Uint8Array;
+}
+
+export interface IBLAKE3Subtree {
+	/**
+	 * Chaining value of the subtree (32 bytes)
+	 */
+	cv: Uint8Array;
+	/**
+	 * Index of the first chunk of the subtree in the content
+	 */
+	chunkOffset: number;
+	/**
+	 * Number of chunks (1024 bytes) in the subtree
+	 */
+	chunks: number;
+	/**
+	 * Length of the subtree content in bytes
+	 */
+	length: number;
+}
+
+function withInstance<T>(fn: (wasm: IWASMInterface) => T): Promise<T> {
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 32).then((wasm) => {
+			wasmCache = wasm;
+			return fn(wasm);
+		});
+	}
+
+	try {
+		return Promise.resolve(fn(wasmCache));
+	} catch (err) {
+		return Promise.reject(err);
+	}
+}
+
+// number of chunks in the left subtree: the largest power of 2,
+// which leaves at least one chunk for the right subtree
+function getLeftChunks(chunks: number): number {
+	let left = 1;
+	while (left * 2 < chunks) {
+		left *= 2;
+	}
+	return left;
+}
+
+function getChunkCount(length: number): number {
+	return Math.max(1, Math.ceil(length / CHUNK_LEN));
+}
+
+function toHex(hash: Uint8Array): string {
+	return getDigestHex(new Uint8Array(CV_LEN * 2), hash, CV_LEN);
+}
+
+// chaining values of the chunks of data, the first one is at firstChunk
+function getChunkCVs(
+	wasm: IWASMInterface,
+	data: Uint8Array,
+	firstChunk: number,
+): Uint8Array {
+	const cvs = new Uint8Array(getChunkCount(data.length) * CV_LEN);
+	const memory = wasm.getMemory();
+	for (let read = 0; read < data.length; read += MAX_HEAP) {
+		const slice = data.subarray(read, read + MAX_HEAP);
+		const counter = firstChunk + read / CHUNK_LEN;
+		wasm.writeMemory(slice);
+		wasm
+			.getExports()
+			.Hash_ChunkCVs(
+				slice.length,
+				counter % 0x100000000,
+				Math.floor(counter / 0x100000000),
+				0,
+			);
+		const length = getChunkCount(slice.length) * CV_LEN;
+		cvs.set(memory.subarray(0, length), (read / CHUNK_LEN) * CV_LEN);
+	}
+	return cvs;
+}
+
+// root hash of content, which fits into a single chunk
+function getChunkRoot(wasm: IWASMInterface, data: Uint8Array): Uint8Array {
+	wasm.writeMemory(data);
+	wasm.getExports().Hash_ChunkCVs(data.length, 0, 0, 1);
+	return wasm.getMemory().slice(0, CV_LEN);
+}
+
+// chaining value (or root hash) of a parent node
+function getParentCV(
+	wasm: IWASMInterface,
+	node: Uint8Array,
+	isRoot: boolean,
+): Uint8Array {
+	wasm.writeMemory(node);
+	wasm.getExports().Hash_ParentCVs(1, isRoot ? 1 : 0);
+	return wasm.getMemory().slice(0, CV_LEN);
+}
+
+function readContentLength(outboard: Uint8Array): number {
+	if (!(outboard instanceof Uint8Array) || outboard.length < HEADER_LEN) {
+		throw new Error("Invalid outboard");
+	}
+
+	const view = new DataView(outboard.buffer, outboard.byteOffset, HEADER_LEN);
+	const length =
+		view.getUint32(0, true) + view.getUint32(4, true) * 0x100000000;
+	const chunks = getChunkCount(length);
+	if (outboard.length !== HEADER_LEN + (chunks - 1) * PARENT_LEN) {
+		throw new Error("Invalid outboard");
+	}
+	return length;
+}
+
+function encodeOutboard(
+	wasm: IWASMInterface,
+	data: Uint8Array,
+): IBLAKE3Outboard {
+	const chunks = getChunkCount(data.length);
+	const outboard = new Uint8Array(HEADER_LEN + (chunks - 1) * PARENT_LEN);
+	const view = new DataView(outboard.buffer);
+	view.setUint32(0, data.length % 0x100000000, true);
+	view.setUint32(4, Math.floor(data.length / 0x100000000), true);
+
+	if (chunks === 1) {
+		return { hash: toHex(getChunkRoot(wasm, data)), outboard };
+	}
+
+	const cvs = getChunkCVs(wasm, data, 0);
+
+	// the parent node of a subtree is followed by the nodes of its left
+	// subtree (left - 1 nodes) and the nodes of its right subtree
+	const encode = (
+		first: number,
+		count: number,
+		position: number,
+		isRoot: boolean,
+	): Uint8Array => {
+		if (count === 1) {
+			return cvs.subarray(first * CV_LEN, (first + 1) * CV_LEN);
+		}
+
+		const left = getLeftChunks(count);
+		const node = outboard.subarray(position, position + PARENT_LEN);
+		node.set(encode(first, left, position + PARENT_LEN, false), 0);
+		node.set(
+			encode(first + left, count - left, position + left * PARENT_LEN, false),
+			CV_LEN,
+		);
+		return getParentCV(wasm, node, isRoot);
+	};
+
+	const root = encode(0, chunks, HEADER_LEN, true);
+	return { hash: toHex(root), outboard };
+}
+
+/**
+ * Calculates the root hash from the chunks of data at offset and the
+ * parent nodes of the outboard, which cover the rest of the content.
+ * The parent nodes above the chunks are replaced if update is set.
+ */
+function hashRange(
+	wasm: IWASMInterface,
+	outboard: Uint8Array,
+	offset: number,
+	data: Uint8Array,
+	update: boolean,
+): string {
+	const contentLength = readContentLength(outboard);
+	const end = offset + data.length;
+	if (
+		!Number.isInteger(offset) ||
+		offset < 0 ||
+		offset % CHUNK_LEN !== 0 ||
+		end > contentLength ||
+		(data.length % CHUNK_LEN !== 0 && end !== contentLength) ||
+		(data.length === 0 && contentLength !== 0)
+	) {
+		throw new Error(
+			"The range should contain whole chunks (1024 bytes) of the content",
+		);
+	}
+
+	const chunks = getChunkCount(contentLength);
+	if (chunks === 1) {
+		return toHex(getChunkRoot(wasm, data));
+	}
+
+	const firstChunk = offset / CHUNK_LEN;
+	const endChunk = Math.ceil(end / CHUNK_LEN);
+	const cvs = getChunkCVs(wasm, data, firstChunk);
+
+	const visit = (
+		first: number,
+		count: number,
+		position: number,
+		isRoot: boolean,
+	): Uint8Array => {
+		if (count === 1) {
+			const index = first - firstChunk;
+			return cvs.subarray(index * CV_LEN, (index + 1) * CV_LEN);
+		}
+
+		// the subtrees outside of the range are taken from the outboard
+		const left = getLeftChunks(count);
+		const stored = outboard.subarray(position, position + PARENT_LEN);
+		const node = update ? stored : stored.slice();
+		if (first < endChunk && first + left > firstChunk) {
+			node.set(visit(first, left, position + PARENT_LEN, false), 0);
+		}
+		if (first + left < endChunk && first + count > firstChunk) {
+			const rightPosition = position + left * PARENT_LEN;
+			node.set(
+				visit(first + left, count - left, rightPosition, false),
+				CV_LEN,
+			);
+		}
+		return getParentCV(wasm, node, isRoot);
+	};
+
+	return toHex(visit(0, chunks, HEADER_LEN, true));
+}
+
+function hashSubtree(
+	wasm: IWASMInterface,
+	data: Uint8Array,
+	chunkOffset: number,
+): IBLAKE3Subtree {
+	if (data.length === 0) {
+		throw new Error("Subtree should not be empty");
+	}
+
+	const chunks = getChunkCount(data.length);
+	let alignment = 1;
+	while (alignment < chunks) {
+		alignment *= 2;
+	}
+	if (
+		!Number.isSafeInteger(chunkOffset) ||
+		chunkOffset < 0 ||
+		chunkOffset % alignment !== 0
+	) {
+		throw new Error("Chunk offset should be aligned to the subtree size");
+	}
+
+	const exports = wasm.getExports();
+	exports.Hash_InitSubtree(
+		chunkOffset % 0x100000000,
+		Math.floor(chunkOffset / 0x100000000),
+	);
+	for (let read = 0; read < data.length; read += MAX_HEAP) {
+		const slice = data.subarray(read, read + MAX_HEAP);
+		wasm.writeMemory(slice);
+		exports.Hash_Update(slice.length);
+	}
+	exports.Hash_FinalSubtree();
+	const cv = wasm.getMemory().slice(0, CV_LEN);
+	return { cv, chunkOffset, chunks, length: data.length };
+}
+
+function mergeSubtrees(
+	wasm: IWASMInterface,
+	subtrees: IBLAKE3Subtree[],
+	hashLength: number,
+): string {
+	if (!Array.isArray(subtrees) || subtrees.length < 2) {
+		throw new Error("At least two subtrees are required");
+	}
+
+	let nextChunk = 0;
+	for (let i = 0; i < subtrees.length; i++) {
+		const { cv, chunkOffset, chunks, length } = subtrees[i];
+		const isLast = i === subtrees.length - 1;
+		if (
+			!(cv instanceof Uint8Array) ||
+			cv.length !== CV_LEN ||
+			chunkOffset !== nextChunk ||
+			!Number.isSafeInteger(length) ||
+			length < 1 ||
+			chunks !== getChunkCount(length) ||
+			// only the last subtree can end with a partial chunk
+			(!isLast && length !== chunks * CHUNK_LEN) ||
+			// only the last subtree can have a size, which is not a power of 2
+			(!isLast && (chunks & (chunks - 1)) !== 0) ||
+			(!isLast && chunkOffset % chunks !== 0)
+		) {
+			throw new Error("The subtrees should cover the content in order");
+		}
+		nextChunk += chunks;
+	}
+
+	// the subtrees are merged lazily, the root is calculated on finalization
+	const exports = wasm.getExports();
+	exports.Hash_Init(0);
+	for (const { cv, chunkOffset } of subtrees) {
+		wasm.writeMemory(cv);
+		exports.Hash_PushSubtree(
+			chunkOffset % 0x100000000,
+			Math.floor(chunkOffset / 0x100000000),
+		);
+	}
+	exports.Hash_Final(hashLength);
+	return getDigestHex(
+		new Uint8Array(hashLength * 2),
+		wasm.getMemory(),
+		hashLength,
+	);
+}
+
+/**
+ * Calculates the BLAKE3 hash of the data with its outboard tree, which
+ * stores the chaining values of the parent nodes separately from the data
+ * @param data Input data (string, Buffer or TypedArray)
+ * @returns The root hash and the outboard
+ */
+export function blake3Outboard(data: IDataType): Promise<IBLAKE3Outboard> {
+	return withInstance((wasm) => encodeOutboard(wasm, getUInt8Buffer(data)));
+}
+
+/**
+ * Verifies a range of the content against its root hash, without hashing
+ * the rest of the content. The range has to start at a chunk boundary
+ * (1024 bytes) and contain whole chunks, except at the end of the content.
+ * @param outboard Outboard created by blake3Outboard()
+ * @param hash Root hash as a hexadecimal string
+ * @param offset Offset of the range in the content in bytes
+ * @param data Content of the range
+ */
+export function blake3VerifyRange(
+	outboard: Uint8Array,
+	hash: string,
+	offset: number,
+	data: IDataType,
+): Promise<boolean> {
+	return withInstance(
+		(wasm) =>
+			hashRange(wasm, outboard, offset, getUInt8Buffer(data), false) ===
+			hash.toLowerCase(),
+	);
+}
+
+/**
+ * Updates the outboard after the content was changed in place. Only the
+ * changed chunks and the parent nodes above them are hashed again.
+ * The range has the same alignment requirements as in blake3VerifyRange()
+ * and the content length cannot change.
+ * @param outboard Outboard created by blake3Outboard(), updated in place
+ * @param offset Offset of the changed range in the content in bytes
+ * @param data New content of the range
+ * @returns The new root hash as a hexadecimal string
+ */
+export function blake3UpdateOutboard(
+	outboard: Uint8Array,
+	offset: number,
+	data: IDataType,
+): Promise<string> {
+	return withInstance((wasm) =>
+		hashRange(wasm, outboard, offset, getUInt8Buffer(data), true),
+	);
+}
+
+/**
+ * Calculates the chaining value of a subtree of a larger content, so the
+ * content can be hashed in shards on different machines. The subtree
+ * starts at chunkOffset (in 1024 byte chunks), which has to be a multiple
+ * of its chunk count rounded up to a power of two. Only the last subtree
+ * of the content can have a partial chunk or a chunk count, which is not a
+ * power of two.
+ * @param data Content of the subtree (string, Buffer or TypedArray)
+ * @param chunkOffset Index of the first chunk of the subtree
+ * @returns The subtree to be merged with blake3MergeSubtrees()
+ */
+export function blake3HashSubtree(
+	data: IDataType,
+	chunkOffset: number,
+): Promise<IBLAKE3Subtree> {
+	return withInstance((wasm) =>
+		hashSubtree(wasm, getUInt8Buffer(data), chunkOffset),
+	);
+}
+
+/**
+ * Calculates the BLAKE3 root hash of the content from the chaining values
+ * of its subtrees, without accessing the content itself. The subtrees have
+ * to cover the content in order, starting at the first chunk.
+ * @param subtrees At least two subtrees created by blake3HashSubtree()
+ * @param bits Number of output bits, which has to be a number
+ *             divisible by 8. Defaults to 256.
+ * @returns Computed hash as a hexadecimal string
+ */
+export function blake3MergeSubtrees(
+	subtrees: IBLAKE3Subtree[],
+	bits = 256,
+): Promise<string> {
+	if (!Number.isInteger(bits) || bits < 8 || bits % 8 !== 0) {
+		return Promise.reject(
+			new Error("Invalid variant! Valid values: 8, 16, ..."),
+		);
+	}
+
+	const hashLength = bits / 8;
+	if (hashLength > MAX_HEAP) {
+		return Promise.reject(
+			new Error(`Output should not be longer than ${MAX_HEAP * 8} bits`),
+		);
+	}
+
+	return withInstance((wasm) => mergeSubtrees(wasm, subtrees, hashLength));
+}
@@ -0,0 +1,85 @@
+/**
+ * Instance of a WASM module, which stores the states of the multiplexed
+ * hashers in separate contexts (Hash_CreateContext() exports)
+ */
+export interface IContextHost {
+	instance: WebAssembly.Instance;
+	/**
+	 * Id of the selected context, 0 is the static context of the module
+	 */
+	current: number;
+	/**
+	 * Number of allocated contexts
+	 */
+	count: number;
+}
+
+interface IContextReference {
+	host: IContextHost;
+	id: number;
+}
+
+const hosts = new Map<string, IContextHost>();
+
+function releaseContext({ host, id }: IContextReference) {
+	// biome-ignore lint/suspicious/noExplicitAny: the exports are not typed
+	const exports = host.instance.exports as any;
+	exports.Hash_DestroyContext(id);
+	host.count--;
+	if (host.current === id) {
+		host.current = 0;
+	}
+}
+
+// releases the contexts of the hashers, which were garbage collected
+// biome-ignore lint/suspicious/noExplicitAny: FinalizationRegistry is not in the configured libs
+const Registry = (globalThis as any).FinalizationRegistry;
+const registry = Registry ? new Registry(releaseContext) : null;
+
+export function getContextHost(name: string): IContextHost {
+	return hosts.get(name) ?? null;
+}
+
+/**
+ * Registers the instance, which hosts the contexts of the module.
+ * Returns the already registered host if there is one
+ */
+export function addContextHost(
+	name: string,
+	instance: WebAssembly.Instance,
+): IContextHost {
+	if (typeof instance.exports.Hash_CreateContext !== "function") {
+		throw new Error(`Multiplexed hashers are not supported by ${name}`);
+	}
+
+	if (!hosts.has(name)) {
+		hosts.set(name, { instance, current: 0, count: 0 });
+	}
+	return hosts.get(name);
+}
+
+/**
+ * Allocates a new context for the owner object.
+ * The context is released if the owner is garbage collected.
+ */
+export function createContext(owner: object, host: IContextHost): number {
+	// biome-ignore lint/suspicious/noExplicitAny: the exports are not typed
+	const exports = host.instance.exports as any;
+	const id: number = exports.Hash_CreateContext();
+	if (id === 0) {
+		throw new Error("Out of memory for new hashing contexts");
+	}
+
+	host.count++;
+	registry?.register(owner, { host, id }, owner);
+	return id;
+}
+
+export function destroyContext(
+	owner: object,
+	host: IContextHost,
+	id: number,
+) {
+	registry?.unregister(owner);
+	releaseContext({ host, id });
+}
@@ -1,14 +1,19 @@
 import wasmJson from "../wasm/crc32.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
-import type { IDataType } from "./util";
+import sharedCreate from "./sharedCreate";
+import {
+	type IDataType,
+	getDigestHex,
+	isHexString,
+	writeHexToUInt8,
+} from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
 function validatePoly(poly: number) {
@@ -33,7 +38,7 @@ export function crc32(
 	}
 
 	if (wasmCache === null) {
-		return lockedCreate(mutex, wasmJson, 4).then((wasm) => {
+		return sharedCreate(wasmJson, 4).then((wasm) => {
 			wasmCache = wasm;
 			return wasmCache.calculate(data, polynomial);
 		});
@@ -47,36 +52,130 @@ export function crc32(
 	}
 }
 
+function validateCombine(crc1: string, crc2: string, length2: number) {
+	if (!isHexString(crc1, 4) || !isHexString(crc2, 4)) {
+		return new Error("Checksums must be 8 char long hex strings");
+	}
+	if (!Number.isSafeInteger(length2) || length2 < 0) {
+		return new Error("Length must be a non-negative integer");
+	}
+	return null;
+}
+
+/**
+ * Combines the CRC-32 checksums of two consecutive parts of the data into
+ * the checksum of the whole data, without accessing the data.
+ * It uses precomputed x^(2^k) operators like zlib's crc32_combine()
+ * @param crc1 Checksum of the first part as a hexadecimal string
+ * @param crc2 Checksum of the second part as a hexadecimal string
+ * @param length2 Length of the second part in bytes
+ * @param polynomial Input polynomial (defaults to 0xedb88320, for CRC32C use 0x82f63b78)
+ * @returns Combined checksum as a hexadecimal string
+ */
+export function crc32Combine(
+	crc1: string,
+	crc2: string,
+	length2: number,
+	polynomial = 0xedb88320,
+): Promise<string> {
+	if (validatePoly(polynomial)) {
+		return Promise.reject(validatePoly(polynomial));
+	}
+
+	if (validateCombine(crc1, crc2, length2)) {
+		return Promise.reject(validateCombine(crc1, crc2, length2));
+	}
+
+	const combine = () => {
+		const checksums = new Uint8Array(8);
+		writeHexToUInt8(checksums, crc1 + crc2);
+		wasmCache.writeMemory(checksums);
+		wasmCache
+			.getExports()
+			.Hash_Combine(
+				polynomial,
+				length2 % 0x100000000,
+				Math.floor(length2 / 0x100000000),
+			);
+		return getDigestHex(new Uint8Array(8), wasmCache.getMemory(), 4);
+	};
+
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 4).then((wasm) => {
+			wasmCache = wasm;
+			return combine();
+		});
+	}
+
+	try {
+		return Promise.resolve(combine());
+	} catch (err) {
+		return Promise.reject(err);
+	}
+}
+
+function createHasher(wasm: IWASMInterface, polynomial: number): IHasher {
+	wasm.init(polynomial);
+	const obj: IHasher = {
+		init: () => {
+			wasm.init(polynomial);
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType, polynomial) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 4,
+		digestSize: 4,
+	};
+	return obj;
+}
+
 /**
  * Creates a new CRC-32 hash instance
  * @param polynomial Input polynomial (defaults to 0xedb88320, for CRC32C use 0x82f63b78)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createCRC32(polynomial = 0xedb88320): Promise<IHasher> {
+export function createCRC32(
+	polynomial = 0xedb88320,
+	options?: IHasherOptions,
+): Promise<IHasher> {
 	if (validatePoly(polynomial)) {
 		return Promise.reject(validatePoly(polynomial));
 	}
 
-	return WASMInterface(wasmJson, 4).then((wasm) => {
-		wasm.init(polynomial);
-		const obj: IHasher = {
-			init: () => {
-				wasm.init(polynomial);
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 4,
-			digestSize: 4,
-		};
-		return obj;
-	});
+	return WASMInterface(wasmJson, 4, options).then((wasm) =>
+		createHasher(wasm, polynomial),
+	);
+}
+
+/**
+ * Creates a new CRC-32 hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param polynomial Input polynomial (defaults to 0xedb88320, for CRC32C use 0x82f63b78)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createCRC32Sync(
+	polynomial = 0xedb88320,
+	options?: IHasherOptions,
+): IHasher {
+	if (validatePoly(polynomial)) {
+		throw validatePoly(polynomial);
+	}
+
+	return createHasher(WASMInterfaceSync(wasmJson, 4, options), polynomial);
 }
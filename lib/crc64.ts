@@ -1,14 +1,19 @@
 import wasmJson from "../wasm/crc64.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
-import type { IDataType } from "./util";
+import sharedCreate from "./sharedCreate";
+import {
+	type IDataType,
+	getDigestHex,
+	isHexString,
+	writeHexToUInt8,
+} from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 const polyBuffer = new Uint8Array(8);
 
@@ -52,7 +57,7 @@ export function crc64(
 	}
 
 	if (wasmCache === null) {
-		return lockedCreate(mutex, wasmJson, 8).then((wasm) => {
+		return sharedCreate(wasmJson, 8).then((wasm) => {
 			wasmCache = wasm;
 			writePoly(polyBuffer.buffer, lo, hi);
 			wasmCache.writeMemory(polyBuffer);
@@ -70,41 +75,131 @@ export function crc64(
 	}
 }
 
+/**
+ * Combines the CRC-64 checksums of two consecutive parts of the data into
+ * the checksum of the whole data, without accessing the data.
+ * It uses precomputed x^(2^k) operators like zlib's crc32_combine()
+ * @param crc1 Checksum of the first part as a hexadecimal string
+ * @param crc2 Checksum of the second part as a hexadecimal string
+ * @param length2 Length of the second part in bytes
+ * @param polynomial Input polynomial (defaults to 'c96c5795d7870f42' - ECMA)
+ * @returns Combined checksum as a hexadecimal string
+ */
+export function crc64Combine(
+	crc1: string,
+	crc2: string,
+	length2: number,
+	polynomial = "c96c5795d7870f42",
+): Promise<string> {
+	const { hi, lo, err } = parsePoly(polynomial);
+	if (err !== null) {
+		return Promise.reject(err);
+	}
+
+	if (!isHexString(crc1, 8) || !isHexString(crc2, 8)) {
+		return Promise.reject(
+			new Error("Checksums must be 16 char long hex strings"),
+		);
+	}
+
+	if (!Number.isSafeInteger(length2) || length2 < 0) {
+		return Promise.reject(new Error("Length must be a non-negative integer"));
+	}
+
+	const combine = () => {
+		// the polynomial is followed by the checksums
+		const params = new Uint8Array(24);
+		writePoly(params.buffer, lo, hi);
+		writeHexToUInt8(params.subarray(8), crc1 + crc2);
+		wasmCache.writeMemory(params);
+		wasmCache
+			.getExports()
+			.Hash_Combine(length2 % 0x100000000, Math.floor(length2 / 0x100000000));
+		return getDigestHex(new Uint8Array(16), wasmCache.getMemory(), 8);
+	};
+
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 8).then((wasm) => {
+			wasmCache = wasm;
+			return combine();
+		});
+	}
+
+	try {
+		return Promise.resolve(combine());
+	} catch (err) {
+		return Promise.reject(err);
+	}
+}
+
+function createHasher(wasm: IWASMInterface, lo: number, hi: number): IHasher {
+	const instanceBuffer = new Uint8Array(8);
+	writePoly(instanceBuffer.buffer, lo, hi);
+	wasm.writeMemory(instanceBuffer);
+	wasm.init();
+	const obj: IHasher = {
+		init: () => {
+			wasm.writeMemory(instanceBuffer);
+			wasm.init();
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 8,
+		digestSize: 8,
+	};
+	return obj;
+}
+
 /**
  * Creates a new CRC-64 hash instance
  * @param polynomial Input polynomial (defaults to 'c96c5795d7870f42' - ECMA)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createCRC64(polynomial = "c96c5795d7870f42"): Promise<IHasher> {
+export function createCRC64(
+	polynomial = "c96c5795d7870f42",
+	options?: IHasherOptions,
+): Promise<IHasher> {
 	const { hi, lo, err } = parsePoly(polynomial);
 	if (err !== null) {
 		return Promise.reject(err);
 	}
 
-	return WASMInterface(wasmJson, 8).then((wasm) => {
-		const instanceBuffer = new Uint8Array(8);
-		writePoly(instanceBuffer.buffer, lo, hi);
-		wasm.writeMemory(instanceBuffer);
-		wasm.init();
-		const obj: IHasher = {
-			init: () => {
-				wasm.writeMemory(instanceBuffer);
-				wasm.init();
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 8,
-			digestSize: 8,
-		};
-		return obj;
-	});
+	return WASMInterface(wasmJson, 8, options).then((wasm) =>
+		createHasher(wasm, lo, hi),
+	);
+}
+
+/**
+ * Creates a new CRC-64 hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param polynomial Input polynomial (defaults to 'c96c5795d7870f42' - ECMA)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createCRC64Sync(
+	polynomial = "c96c5795d7870f42",
+	options?: IHasherOptions,
+): IHasher {
+	const { hi, lo, err } = parsePoly(polynomial);
+	if (err !== null) {
+		throw err;
+	}
+
+	return createHasher(WASMInterfaceSync(wasmJson, 8, options), lo, hi);
 }
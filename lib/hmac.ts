@@ -1,5 +1,5 @@
-import type { IHasher } from "./WASMInterface";
-import { type IDataType, getUInt8Buffer } from "./util";
+import { type IHasher, type INativeHmac, getNativeHmac } from "./WASMInterface";
+import { type IDataType, getDigestHex, getUInt8Buffer } from "./util";
 
 function calculateKeyBuffer(hasher: IHasher, key: IDataType): Uint8Array {
 	const { blockSize } = hasher;
@@ -16,11 +16,111 @@ function calculateKeyBuffer(hasher: IHasher, key: IDataType): Uint8Array {
 	return new Uint8Array(buf.buffer, buf.byteOffset, buf.length);
 }
 
+function trySaveState(hasher: IHasher, paddedKey: Uint8Array): Uint8Array {
+	hasher.init();
+	hasher.update(paddedKey);
+	try {
+		return hasher.save();
+	} catch {
+		return null;
+	}
+}
+
+function hashOneByOne(
+	hmac: IHasher,
+	messages: IDataType[],
+	outputType: "hex" | "binary",
+): Uint8Array | string[] {
+	if (!Array.isArray(messages)) {
+		throw new Error("hashMany() expects an array of messages");
+	}
+
+	const { digestSize } = hmac;
+	const result = new Uint8Array(messages.length * digestSize);
+	for (let i = 0; i < messages.length; i++) {
+		hmac.init();
+		hmac.update(messages[i]);
+		hmac.digestInto(result, i * digestSize);
+	}
+
+	if (outputType === "binary") {
+		return result;
+	}
+
+	const digestChars = new Uint8Array(digestSize * 2);
+	return messages.map((_, i) =>
+		getDigestHex(digestChars, result, digestSize, i * digestSize),
+	);
+}
+
+function calculateNativeHmac(
+	hasher: IHasher,
+	native: INativeHmac,
+	key: Uint8Array,
+): IHasher {
+	const { blockSize } = hasher;
+
+	// the module only holds the key states of the HMAC instance
+	// which used it last
+	const activate = () => {
+		if (native.owner !== obj) {
+			native.init(key, blockSize, obj);
+		}
+	};
+
+	const obj: IHasher = {
+		init: () => {
+			if (native.owner !== obj) {
+				native.init(key, blockSize, obj);
+			} else {
+				native.reset();
+			}
+			return obj;
+		},
+
+		update: (data: IDataType) => {
+			hasher.update(data);
+			return obj;
+		},
+
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: ((outputType) => native.digest(outputType)) as any,
+
+		digestInto: (target, offset) => native.digestInto(target, offset),
+
+		hashMany: ((messages, outputType) => {
+			activate();
+			return native.hashMany(obj, messages, outputType);
+			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		}) as any,
+
+		save: () => hasher.save(),
+		load: (state: Uint8Array) => {
+			activate();
+			hasher.load(state);
+			return obj;
+		},
+
+		release: () => hasher.release(),
+		blockSize,
+		digestSize: hasher.digestSize,
+	};
+
+	native.init(key, blockSize, obj);
+	return obj;
+}
+
 function calculateHmac(hasher: IHasher, key: IDataType): IHasher {
 	hasher.init();
 
 	const { blockSize } = hasher;
 	const keyBuf = calculateKeyBuffer(hasher, key);
+
+	const native = getNativeHmac(hasher);
+	if (native !== null) {
+		return calculateNativeHmac(hasher, native, keyBuf.slice());
+	}
+
 	const keyBuffer = new Uint8Array(blockSize);
 	keyBuffer.set(keyBuf);
 
@@ -32,12 +132,36 @@ function calculateHmac(hasher: IHasher, key: IDataType): IHasher {
 		keyBuffer[i] = v ^ 0x36;
 	}
 
-	hasher.update(keyBuffer);
+	// the states after absorbing the padded keys are computed only once
+	// and restored with load() instead of hashing the keys again
+	const innerState = trySaveState(hasher, keyBuffer);
+	const outerState = trySaveState(hasher, opad);
 
-	const obj: IHasher = {
-		init: () => {
+	const startInnerHash = () => {
+		if (innerState !== null) {
+			hasher.load(innerState);
+		} else {
 			hasher.init();
 			hasher.update(keyBuffer);
+		}
+	};
+
+	const startOuterHash = () => {
+		const uintArr = hasher.digest("binary");
+		if (outerState !== null) {
+			hasher.load(outerState);
+		} else {
+			hasher.init();
+			hasher.update(opad);
+		}
+		hasher.update(uintArr);
+	};
+
+	startInnerHash();
+
+	const obj: IHasher = {
+		init: () => {
+			startInnerHash();
 			return obj;
 		},
 
@@ -47,20 +171,27 @@ function calculateHmac(hasher: IHasher, key: IDataType): IHasher {
 		},
 
 		digest: ((outputType) => {
-			const uintArr = hasher.digest("binary");
-			hasher.init();
-			hasher.update(opad);
-			hasher.update(uintArr);
+			startOuterHash();
 			return hasher.digest(outputType);
 			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
 		}) as any,
-		save: () => {
-			throw new Error("save() not supported");
+
+		digestInto: (target, offset) => {
+			startOuterHash();
+			return hasher.digestInto(target, offset);
 		},
-		load: () => {
-			throw new Error("load() not supported");
+
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			hashOneByOne(obj, messages, outputType) as any,
+
+		save: () => hasher.save(),
+		load: (state: Uint8Array) => {
+			hasher.load(state);
+			return obj;
 		},
 
+		release: () => hasher.release(),
 		blockSize: hasher.blockSize,
 		digestSize: hasher.digestSize,
 	};
@@ -68,7 +199,9 @@ function calculateHmac(hasher: IHasher, key: IDataType): IHasher {
 }
 
 /**
- * Calculates HMAC hash
+ * Calculates HMAC hash.
+ * The state returned by save() contains key-derived data and it can only
+ * be loaded into an HMAC instance created with the same key.
  * @param hash Hash algorithm to use. It has to be the return value of a function like createSHA1()
  * @param key Key (string, Buffer or TypedArray)
  */
@@ -84,3 +217,20 @@ export function createHMAC(
 
 	return hash.then((hasher) => calculateHmac(hasher, key));
 }
+
+/**
+ * Calculates HMAC hash synchronously.
+ * The state returned by save() contains key-derived data and it can only
+ * be loaded into an HMAC instance created with the same key.
+ * @param hasher Hash instance to use. It has to be the return value of a function like createSHA1Sync()
+ * @param key Key (string, Buffer or TypedArray)
+ */
+export function createHMACSync(hasher: IHasher, key: IDataType): IHasher {
+	if (!hasher || typeof hasher.init !== "function") {
+		throw new Error(
+			'Invalid hash function is provided! Usage: createHMACSync(createMD5Sync(), "key").',
+		);
+	}
+
+	return calculateHmac(hasher, key);
+}
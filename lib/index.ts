@@ -3,6 +3,7 @@ export * from "./argon2";
 export * from "./blake2b";
 export * from "./blake2s";
 export * from "./blake3";
+export * from "./blake3Tree";
 export * from "./crc32";
 export * from "./crc64";
 export * from "./md4";
@@ -25,6 +26,18 @@ export * from "./scrypt";
 export * from "./bcrypt";
 export * from "./whirlpool";
 export * from "./sm3";
+export * from "./preload";
+export { type IWASMLocation, setWASMLocation } from "./wasmLoader";
+export { enableSharedMemory } from "./sharedMemory";
+export { getPoolStats, type IPoolStats, setMaxPoolSize } from "./pool";
+export type { IKDFEngineOptions } from "./kdfEngine";
+export {
+	createHashSink,
+	hashBlob,
+	type IHashBlobOptions,
+	type IHashSink,
+	type IHashStreamOptions,
+} from "./stream";
 
 export type { IDataType } from "./util";
-export type { IHasher } from "./WASMInterface";
+export type { IHasher, IHasherOptions } from "./WASMInterface";
@@ -0,0 +1,135 @@
+import { type IWASMInterface, WASMInterface } from "./WASMInterface";
+import type { IEmbeddedWasm } from "./util";
+
+// limits of the --max-memory linker flags of the argon2 and scrypt modules
+// (wasm32 and memory64 builds), minus their initial memory of 128 KiB
+const MAX_WASM32_MEMORY = 2 * 1024 * 1024 * 1024 - 131072;
+const MAX_WASM64_MEMORY = 16 * 1024 * 1024 * 1024 - 131072;
+
+// (module (memory i64 0))
+const MEMORY64_PROBE = new Uint8Array([
+	0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x05, 0x03, 0x01, 0x04, 0x00,
+]);
+
+let memory64Supported: boolean = null;
+
+function isMemory64Supported(): boolean {
+	if (memory64Supported === null) {
+		memory64Supported = WebAssembly.validate(MEMORY64_PROBE);
+	}
+
+	return memory64Supported;
+}
+
+function getMaxMemory(): number {
+	return isMemory64Supported() ? MAX_WASM64_MEMORY : MAX_WASM32_MEMORY;
+}
+
+/**
+ * Returns the wasm32 build of a key derivation function, or its memory64
+ * build if the calculation does not fit into the 2 GiB limit of wasm32
+ * @param memorySize Memory required by the calculation in bytes
+ */
+export function selectKDFBinary(
+	binary: IEmbeddedWasm,
+	binary64: IEmbeddedWasm,
+	memorySize: number,
+): IEmbeddedWasm {
+	if (memorySize <= MAX_WASM32_MEMORY) {
+		return binary;
+	}
+
+	if (memorySize > getMaxMemory()) {
+		const reason = isMemory64Supported()
+			? `the limit is ${MAX_WASM64_MEMORY} bytes`
+			: "the WebAssembly engine does not support memory64";
+		throw new Error(
+			`The calculation requires ${memorySize} bytes of memory, ${reason}`,
+		);
+	}
+
+	return binary64;
+}
+
+export interface IKDFEngineOptions {
+	/**
+	 * Maximum amount of memory in bytes, which can be used by a single
+	 * calculation. The memory of the engine grows up to this size.
+	 * Calculations requiring more memory are rejected. Defaults to 2 GiB.
+	 * Larger values (up to 16 GiB) use the memory64 build of the module,
+	 * they require an engine with WebAssembly memory64 support
+	 */
+	maxMemory?: number;
+}
+
+export interface IKDFEngine {
+	/**
+	 * Runs the calculation on the instance of the engine. The calculations
+	 * are synchronous, so they never overlap.
+	 * @param memorySize Memory required by the calculation in bytes
+	 */
+	run: <T>(memorySize: number, job: (wasm: IWASMInterface) => T) => Promise<T>;
+	dispose: () => void;
+}
+
+/**
+ * Creates a WebAssembly instance, which is reused by the calculations of a
+ * key derivation function. Its memory grows to the size required by the
+ * largest calculation, and it is kept until dispose() is called.
+ */
+export async function createKDFEngine(
+	binary: IEmbeddedWasm,
+	binary64: IEmbeddedWasm,
+	hashLength: number,
+	options: IKDFEngineOptions = {},
+): Promise<IKDFEngine> {
+	if (!options || typeof options !== "object") {
+		throw new Error("Invalid options parameter. It requires an object.");
+	}
+
+	const maxMemory = options.maxMemory ?? MAX_WASM32_MEMORY;
+	if (
+		!Number.isInteger(maxMemory) ||
+		maxMemory < 1 ||
+		maxMemory > getMaxMemory()
+	) {
+		throw new Error(
+			`Max memory should be a positive number, not larger than ${getMaxMemory()}`,
+		);
+	}
+
+	// a single instance is used by all calculations, so the build is
+	// selected by the largest allowed memory size
+	const engineBinary = selectKDFBinary(binary, binary64, maxMemory);
+	let wasm = await WASMInterface(engineBinary, hashLength);
+
+	const run = <T>(
+		memorySize: number,
+		job: (wasm: IWASMInterface) => T,
+	): Promise<T> => {
+		if (wasm === null) {
+			return Promise.reject(new Error("The engine was disposed"));
+		}
+
+		if (memorySize > maxMemory) {
+			return Promise.reject(
+				new Error(
+					`The calculation requires ${memorySize} bytes of memory, the limit of the engine is ${maxMemory} bytes`,
+				),
+			);
+		}
+
+		try {
+			return Promise.resolve(job(wasm));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+	};
+
+	// the grown memory is freed when the instance is garbage collected
+	const dispose = () => {
+		wasm = null;
+	};
+
+	return { run, dispose };
+}
@@ -1,15 +1,15 @@
 import wasmJson from "../wasm/sha3.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
+import sharedCreate from "./sharedCreate";
 import type { IDataType } from "./util";
 
 type IValidBits = 224 | 256 | 384 | 512;
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
 function validateBits(bits: IValidBits) {
@@ -36,53 +36,96 @@ export function keccak(
 
 	const hashLength = bits / 8;
 
-	if (wasmCache === null || wasmCache.hashLength !== hashLength) {
-		return lockedCreate(mutex, wasmJson, hashLength).then((wasm) => {
+	if (wasmCache === null) {
+		return sharedCreate(wasmJson, 64).then((wasm) => {
 			wasmCache = wasm;
-			return wasmCache.calculate(data, bits, 0x01);
+			return wasmCache.calculate(data, bits, 0x01, hashLength);
 		});
 	}
 
 	try {
-		const hash = wasmCache.calculate(data, bits, 0x01);
+		const hash = wasmCache.calculate(data, bits, 0x01, hashLength);
 		return Promise.resolve(hash);
 	} catch (err) {
 		return Promise.reject(err);
 	}
 }
 
+function createHasher(
+	wasm: IWASMInterface,
+	bits: number,
+	outputSize: number,
+): IHasher {
+	wasm.init(bits);
+	const obj: IHasher = {
+		init: () => {
+			wasm.init(bits);
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType, 0x01) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset, 0x01),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType, bits, 0x01) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 200 - 2 * outputSize,
+		digestSize: outputSize,
+	};
+	wasm.registerNativeHmac(obj, bits, 0x01);
+	return obj;
+}
+
 /**
  * Creates a new Keccak hash instance
  * @param bits Number of output bits. Valid values: 224, 256, 384, 512
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createKeccak(bits: IValidBits = 512): Promise<IHasher> {
+export function createKeccak(
+	bits: IValidBits = 512,
+	options?: IHasherOptions,
+): Promise<IHasher> {
 	if (validateBits(bits)) {
 		return Promise.reject(validateBits(bits));
 	}
 
 	const outputSize = bits / 8;
 
-	return WASMInterface(wasmJson, outputSize).then((wasm) => {
-		wasm.init(bits);
-		const obj: IHasher = {
-			init: () => {
-				wasm.init(bits);
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType, 0x01) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 200 - 2 * outputSize,
-			digestSize: outputSize,
-		};
-		return obj;
-	});
+	return WASMInterface(wasmJson, outputSize, options).then((wasm) =>
+		createHasher(wasm, bits, outputSize),
+	);
+}
+
+/**
+ * Creates a new Keccak hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param bits Number of output bits. Valid values: 224, 256, 384, 512
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createKeccakSync(
+	bits: IValidBits = 512,
+	options?: IHasherOptions,
+): IHasher {
+	if (validateBits(bits)) {
+		throw validateBits(bits);
+	}
+
+	const outputSize = bits / 8;
+
+	return createHasher(
+		WASMInterfaceSync(wasmJson, outputSize, options),
+		bits,
+		outputSize,
+	);
 }
@@ -1,14 +1,14 @@
 import wasmJson from "../wasm/md5.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
+import sharedCreate from "./sharedCreate";
 import type { IDataType } from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
 /**
@@ -18,7 +18,7 @@ let wasmCache: IWASMInterface = null;
  */
 export function md5(data: IDataType): Promise<string> {
 	if (wasmCache === null) {
-		return lockedCreate(mutex, wasmJson, 16).then((wasm) => {
+		return sharedCreate(wasmJson, 16).then((wasm) => {
 			wasmCache = wasm;
 			return wasmCache.calculate(data);
 		});
@@ -32,31 +32,51 @@ export function md5(data: IDataType): Promise<string> {
 	}
 }
 
+function createHasher(wasm: IWASMInterface): IHasher {
+	wasm.init();
+	const obj: IHasher = {
+		init: () => {
+			wasm.init();
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 64,
+		digestSize: 16,
+	};
+	wasm.registerNativeHmac(obj);
+	return obj;
+}
+
 /**
  * Creates a new MD5 hash instance
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createMD5(options?: IHasherOptions): Promise<IHasher> {
+	return WASMInterface(wasmJson, 16, options).then(createHasher);
+}
+
+/**
+ * Creates a new MD5 hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createMD5(): Promise<IHasher> {
-	return WASMInterface(wasmJson, 16).then((wasm) => {
-		wasm.init();
-		const obj: IHasher = {
-			init: () => {
-				wasm.init();
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 64,
-			digestSize: 16,
-		};
-		return obj;
-	});
+export function createMD5Sync(options?: IHasherOptions): IHasher {
+	return createHasher(WASMInterfaceSync(wasmJson, 16, options));
 }
@@ -0,0 +1,185 @@
+import { open } from "node:fs/promises";
+import { Transform } from "node:stream";
+import type { IHasher } from "./WASMInterface";
+import {
+	ChunkCoalescer,
+	type IHashStreamOptions,
+	validateStreamOptions,
+} from "./stream";
+
+/**
+ * Creates a Node.js Transform stream, which feeds the written chunks into
+ * the hasher and emits the digest as a single chunk when the input ends.
+ * The hasher is initialized when the stream is created.
+ * @param hasher Hasher instance returned by a function like createSHA256()
+ */
+export function createHashStream(
+	hasher: IHasher,
+	options: IHashStreamOptions = {},
+): Transform {
+	const opts = { ...options };
+	validateStreamOptions(hasher, opts);
+
+	const coalescer = new ChunkCoalescer(hasher);
+	hasher.init();
+
+	return new Transform({
+		writableHighWaterMark: opts.highWaterMark,
+		decodeStrings: false,
+		readableObjectMode: opts.outputType === "hex",
+		transform: (chunk, encoding, callback) => {
+			try {
+				coalescer.push(
+					typeof chunk === "string" && encoding !== "utf8"
+						? Buffer.from(chunk, encoding)
+						: chunk,
+				);
+				callback();
+			} catch (err) {
+				callback(err);
+			}
+		},
+		flush: (callback) => {
+			try {
+				coalescer.flush();
+				callback(null, hasher.digest(opts.outputType as "hex"));
+			} catch (err) {
+				callback(err);
+			}
+		},
+	});
+}
+
+export interface IHashFileOptions {
+	/**
+	 * Desired output type of the digests. Defaults to 'hex'
+	 */
+	outputType?: "hex" | "binary";
+	/**
+	 * Number of bytes read from the file at once. Defaults to 512 KiB
+	 */
+	chunkSize?: number;
+}
+
+const DEFAULT_FILE_CHUNK_SIZE = 512 * 1024;
+const MAX_POOLED_BUFFERS = 4;
+const bufferPool = new Map<number, Buffer[]>();
+
+function acquireBuffer(size: number): Buffer {
+	const buffers = bufferPool.get(size);
+	if (buffers?.length) {
+		return buffers.pop();
+	}
+	return Buffer.allocUnsafe(size);
+}
+
+function releaseBuffer(buf: Buffer) {
+	if (!bufferPool.has(buf.length)) {
+		bufferPool.set(buf.length, []);
+	}
+	const buffers = bufferPool.get(buf.length);
+	if (buffers.length < MAX_POOLED_BUFFERS) {
+		buffers.push(buf);
+	}
+}
+
+const validateFileOptions = (
+	hashers: IHasher[],
+	options: IHashFileOptions,
+) => {
+	if (
+		hashers.length === 0 ||
+		hashers.some((hasher) => !hasher || typeof hasher.update !== "function")
+	) {
+		throw new Error(
+			'Invalid hasher is provided! Usage: hashFile("file.bin", await createSHA256()).',
+		);
+	}
+
+	if (options.outputType === undefined) {
+		options.outputType = "hex";
+	}
+
+	if (!["hex", "binary"].includes(options.outputType)) {
+		throw new Error(
+			`Insupported output type ${options.outputType}. Valid values: ['hex', 'binary']`,
+		);
+	}
+
+	if (options.chunkSize === undefined) {
+		options.chunkSize = DEFAULT_FILE_CHUNK_SIZE;
+	}
+
+	if (!Number.isInteger(options.chunkSize) || options.chunkSize < 1) {
+		throw new Error("Chunk size should be a positive number");
+	}
+};
+
+/**
+ * Calculates the hash of a file with one or more hashers.
+ * Reading the next chunk of the file overlaps with hashing the current one.
+ * @param path Path of the file
+ * @param hashers Hasher instance or an array of hasher instances
+ *                returned by functions like createSHA256()
+ * @returns Computed digest, or an array of digests in the order of the hashers
+ */
+export async function hashFile(
+	path: string,
+	hashers: IHasher,
+	options?: IHashFileOptions,
+): Promise<string | Uint8Array>;
+export async function hashFile(
+	path: string,
+	hashers: IHasher[],
+	options?: IHashFileOptions,
+): Promise<(string | Uint8Array)[]>;
+export async function hashFile(
+	path: string,
+	hashers: IHasher | IHasher[],
+	options: IHashFileOptions = {},
+): Promise<string | Uint8Array | (string | Uint8Array)[]> {
+	const list = Array.isArray(hashers) ? hashers : [hashers];
+	const opts = { ...options };
+	validateFileOptions(list, opts);
+
+	for (const hasher of list) {
+		hasher.init();
+	}
+
+	const { chunkSize } = opts;
+	const handle = await open(path, "r");
+	const buffers = [acquireBuffer(chunkSize), acquireBuffer(chunkSize)];
+	let pending = handle.read(buffers[0], 0, chunkSize, 0);
+
+	try {
+		let position = 0;
+		let index = 0;
+
+		while (true) {
+			const { bytesRead } = await pending;
+			if (bytesRead === 0) {
+				break;
+			}
+
+			// start reading the next chunk while the current one is hashed
+			position += bytesRead;
+			const chunk = buffers[index].subarray(0, bytesRead);
+			index ^= 1;
+			pending = handle.read(buffers[index], 0, chunkSize, position);
+
+			for (const hasher of list) {
+				hasher.update(chunk);
+			}
+		}
+	} finally {
+		await pending.catch(() => {});
+		await handle.close();
+		releaseBuffer(buffers[0]);
+		releaseBuffer(buffers[1]);
+	}
+
+	const digests = list.map((hasher) =>
+		hasher.digest(opts.outputType as "hex"),
+	);
+	return Array.isArray(hashers) ? digests : digests[0];
+}
@@ -1,4 +1,4 @@
-import type { IHasher } from "./WASMInterface";
+import { type IHasher, type INativeHmac, getNativeHmac } from "./WASMInterface";
 import { createHMAC } from "./hmac";
 import { type IDataType, getDigestHex, getUInt8Buffer } from "./util";
 
@@ -29,13 +29,12 @@ export interface IPBKDF2Options {
 	outputType?: "hex" | "binary";
 }
 
-async function calculatePBKDF2(
+function deriveKey(
 	digest: IHasher,
 	salt: IDataType,
 	iterations: number,
 	hashLength: number,
-	outputType?: "hex" | "binary",
-): Promise<Uint8Array | string> {
+): Uint8Array {
 	const DK = new Uint8Array(hashLength);
 	const block1 = new Uint8Array(salt.length + 4);
 	const block1View = new DataView(block1.buffer);
@@ -75,6 +74,23 @@ async function calculatePBKDF2(
 		destPos += hLen;
 	}
 
+	return DK;
+}
+
+async function calculatePBKDF2(
+	digest: IHasher,
+	native: INativeHmac,
+	salt: IDataType,
+	iterations: number,
+	hashLength: number,
+	outputType?: "hex" | "binary",
+): Promise<Uint8Array | string> {
+	// the whole iteration loop runs inside WASM when it is supported
+	const DK =
+		(native?.owner === digest &&
+			native.pbkdf2(getUInt8Buffer(salt), iterations, hashLength)) ||
+		deriveKey(digest, salt, iterations, hashLength);
+
 	if (outputType === "binary") {
 		return DK;
 	}
@@ -127,9 +143,11 @@ export async function pbkdf2<T extends IPBKDF2Options>(
 ): Promise<PBKDF2ReturnType<T>> {
 	validateOptions(options);
 
-	const hmac = await createHMAC(options.hashFunction, options.password);
+	const hasher = await options.hashFunction;
+	const hmac = await createHMAC(Promise.resolve(hasher), options.password);
 	return calculatePBKDF2(
 		hmac,
+		getNativeHmac(hasher),
 		options.salt,
 		options.iterations,
 		options.hashLength,
@@ -0,0 +1,123 @@
+export interface IPoolStats {
+	/**
+	 * Released instances waiting in the pool
+	 */
+	idle: number;
+	/**
+	 * Pooled instances which are in use
+	 */
+	inUse: number;
+	/**
+	 * Linear memory of the idle and used instances in bytes
+	 */
+	memoryBytes: number;
+}
+
+interface IPool {
+	idle: WebAssembly.Instance[];
+	inUse: number;
+	memoryInUse: number;
+}
+
+interface IPooledInstance {
+	name: string;
+	instance: WebAssembly.Instance;
+}
+
+const pools = new Map<string, IPool>();
+let maxPoolSize = 64;
+
+const getMemorySize = (instance: WebAssembly.Instance): number =>
+	(instance.exports.memory as WebAssembly.Memory).buffer.byteLength;
+
+function getPool(name: string): IPool {
+	let pool = pools.get(name);
+	if (pool === undefined) {
+		pool = { idle: [], inUse: 0, memoryInUse: 0 };
+		pools.set(name, pool);
+	}
+	return pool;
+}
+
+function returnInstance({ name, instance }: IPooledInstance) {
+	const pool = getPool(name);
+	pool.inUse--;
+	pool.memoryInUse -= getMemorySize(instance);
+	if (pool.idle.length < maxPoolSize) {
+		pool.idle.push(instance);
+	}
+}
+
+// returns the instances of the hashers, which were not released
+// before being garbage collected
+// biome-ignore lint/suspicious/noExplicitAny: FinalizationRegistry is not in the configured libs
+const Registry = (globalThis as any).FinalizationRegistry;
+const registry = Registry ? new Registry(returnInstance) : null;
+
+/**
+ * Takes a released instance of the module from the pool
+ * @returns The instance or null if the pool is empty
+ */
+export function takeInstance(name: string): WebAssembly.Instance {
+	return getPool(name).idle.pop() ?? null;
+}
+
+/**
+ * Starts tracking a pooled instance, which is used by the owner object.
+ * The instance is returned to the pool if the owner is garbage collected.
+ */
+export function trackInstance(
+	owner: object,
+	name: string,
+	instance: WebAssembly.Instance,
+) {
+	const pool = getPool(name);
+	pool.inUse++;
+	pool.memoryInUse += getMemorySize(instance);
+	registry?.register(owner, { name, instance }, owner);
+}
+
+/**
+ * Returns the instance used by the owner object to the pool
+ */
+export function releaseInstance(
+	owner: object,
+	name: string,
+	instance: WebAssembly.Instance,
+) {
+	registry?.unregister(owner);
+	returnInstance({ name, instance });
+}
+
+/**
+ * Sets the maximum number of released instances kept for each algorithm.
+ * Defaults to 64
+ */
+export function setMaxPoolSize(size: number): void {
+	if (!Number.isInteger(size) || size < 0) {
+		throw new Error("Pool size should be a non-negative integer");
+	}
+
+	maxPoolSize = size;
+	for (const pool of pools.values()) {
+		pool.idle.length = Math.min(pool.idle.length, size);
+	}
+}
+
+/**
+ * Returns the state of the instance pools by WASM module name
+ */
+export function getPoolStats(): Record<string, IPoolStats> {
+	const stats: Record<string, IPoolStats> = {};
+	for (const [name, pool] of pools) {
+		stats[name] = {
+			idle: pool.idle.length,
+			inUse: pool.inUse,
+			memoryBytes: pool.idle.reduce(
+				(sum, instance) => sum + getMemorySize(instance),
+				pool.memoryInUse,
+			),
+		};
+	}
+	return stats;
+}
@@ -0,0 +1,105 @@
+import adler32Wasm from "../wasm/adler32.wasm.json";
+import argon2Wasm from "../wasm/argon2.wasm.json";
+import bcryptWasm from "../wasm/bcrypt.wasm.json";
+import blake2bWasm from "../wasm/blake2b.wasm.json";
+import blake2sWasm from "../wasm/blake2s.wasm.json";
+import blake3Wasm from "../wasm/blake3.wasm.json";
+import crc32Wasm from "../wasm/crc32.wasm.json";
+import crc64Wasm from "../wasm/crc64.wasm.json";
+import md4Wasm from "../wasm/md4.wasm.json";
+import md5Wasm from "../wasm/md5.wasm.json";
+import ripemd160Wasm from "../wasm/ripemd160.wasm.json";
+import scryptWasm from "../wasm/scrypt.wasm.json";
+import sha1Wasm from "../wasm/sha1.wasm.json";
+import sha256Wasm from "../wasm/sha256.wasm.json";
+import sha3Wasm from "../wasm/sha3.wasm.json";
+import sha512Wasm from "../wasm/sha512.wasm.json";
+import sm3Wasm from "../wasm/sm3.wasm.json";
+import whirlpoolWasm from "../wasm/whirlpool.wasm.json";
+import xxhash128Wasm from "../wasm/xxhash128.wasm.json";
+import xxhash3Wasm from "../wasm/xxhash3.wasm.json";
+import xxhash32Wasm from "../wasm/xxhash32.wasm.json";
+import xxhash64Wasm from "../wasm/xxhash64.wasm.json";
+import { preloadWASM } from "./WASMInterface";
+import type { IEmbeddedWasm } from "./util";
+
+export type IPreloadAlgorithm =
+	| "adler32"
+	| "argon2"
+	| "bcrypt"
+	| "blake2b"
+	| "blake2s"
+	| "blake3"
+	| "crc32"
+	| "crc64"
+	| "keccak"
+	| "md4"
+	| "md5"
+	| "ripemd160"
+	| "scrypt"
+	| "sha1"
+	| "sha224"
+	| "sha256"
+	| "sha3"
+	| "sha384"
+	| "sha512"
+	| "sm3"
+	| "whirlpool"
+	| "xxhash128"
+	| "xxhash3"
+	| "xxhash32"
+	| "xxhash64";
+
+// some algorithms share the same WASM binary
+const modules: Record<IPreloadAlgorithm, IEmbeddedWasm> = {
+	adler32: adler32Wasm,
+	argon2: argon2Wasm,
+	bcrypt: bcryptWasm,
+	blake2b: blake2bWasm,
+	blake2s: blake2sWasm,
+	blake3: blake3Wasm,
+	crc32: crc32Wasm,
+	crc64: crc64Wasm,
+	keccak: sha3Wasm,
+	md4: md4Wasm,
+	md5: md5Wasm,
+	ripemd160: ripemd160Wasm,
+	scrypt: scryptWasm,
+	sha1: sha1Wasm,
+	sha224: sha256Wasm,
+	sha256: sha256Wasm,
+	sha3: sha3Wasm,
+	sha384: sha512Wasm,
+	sha512: sha512Wasm,
+	sm3: sm3Wasm,
+	whirlpool: whirlpoolWasm,
+	xxhash128: xxhash128Wasm,
+	xxhash3: xxhash3Wasm,
+	xxhash32: xxhash32Wasm,
+	xxhash64: xxhash64Wasm,
+};
+
+/**
+ * Compiles the WebAssembly modules of the given algorithms ahead of time.
+ * After the returned promise is resolved, the synchronous factories
+ * (like createSHA256Sync()) don't have to compile anything and the
+ * asynchronous functions skip the compilation step.
+ * Note that this function references all WASM binaries, which prevents
+ * bundlers from removing the unused ones.
+ * @param algorithms Names of the algorithms, e.g. ['sha256', 'blake3']
+ */
+export function preload(algorithms: IPreloadAlgorithm[]): Promise<void> {
+	if (!Array.isArray(algorithms)) {
+		return Promise.reject(new Error("preload() expects an array of names"));
+	}
+
+	for (const algorithm of algorithms) {
+		if (!Object.prototype.hasOwnProperty.call(modules, algorithm)) {
+			return Promise.reject(new Error(`Unknown algorithm: ${algorithm}`));
+		}
+	}
+
+	return Promise.all(
+		algorithms.map((algorithm) => preloadWASM(modules[algorithm])),
+	).then(() => {});
+}
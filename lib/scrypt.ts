@@ -1,8 +1,12 @@
 import wasmJson from "../wasm/scrypt.wasm.json";
-import { WASMInterface } from "./WASMInterface";
-import { pbkdf2 } from "./pbkdf2";
-import { createSHA256 } from "./sha256";
-import { type IDataType, getDigestHex } from "./util";
+import wasm64Json from "../wasm/scrypt_64.wasm.json";
+import { type IWASMInterface, WASMInterface } from "./WASMInterface";
+import {
+	type IKDFEngineOptions,
+	createKDFEngine,
+	selectKDFBinary,
+} from "./kdfEngine";
+import { type IDataType, getDigestHex, getUInt8Buffer } from "./util";
 
 export interface ScryptOptions {
 	/**
@@ -35,44 +39,67 @@ export interface ScryptOptions {
 	outputType?: "hex" | "binary";
 }
 
-async function scryptInternal(
-	options: ScryptOptions,
-): Promise<string | Uint8Array> {
-	const { costFactor, blockSize, parallelism, hashLength } = options;
-	const SHA256Hasher = createSHA256();
+interface IScryptInput {
+	password: Uint8Array;
+	salt: Uint8Array;
+}
 
-	const blockData = await pbkdf2({
-		password: options.password,
-		salt: options.salt,
-		iterations: 1,
-		hashLength: 128 * blockSize * parallelism,
-		hashFunction: SHA256Hasher,
-		outputType: "binary",
-	});
+function getInput(options: ScryptOptions): IScryptInput {
+	return {
+		password: getUInt8Buffer(options.password),
+		salt: getUInt8Buffer(options.salt),
+	};
+}
 
-	const scryptInterface = await WASMInterface(wasmJson, 0);
+// offset of the password after the blocks, V and XY
+// (with 64 bytes of scratch space)
+function getInputOffset(options: ScryptOptions): number {
+	const { costFactor, blockSize, parallelism } = options;
+	return 128 * blockSize * (parallelism + costFactor) + 256 * blockSize + 64;
+}
 
-	// last block is for storing the temporary vectors
-	const VSize = 128 * blockSize * costFactor;
-	const XYSize = 256 * blockSize;
-	scryptInterface.setMemorySize(blockData.length + VSize + XYSize);
-	scryptInterface.writeMemory(blockData, 0);
+// memory used by the blocks, V, XY, the password, the salt and the derived key
+function getMemorySize(options: ScryptOptions, input: IScryptInput): number {
+	const { password, salt } = input;
+	return (
+		getInputOffset(options) +
+		password.length +
+		salt.length +
+		options.hashLength
+	);
+}
 
-	// mix blocks
-	scryptInterface.getExports().scrypt(blockSize, costFactor, parallelism);
+function calculateScrypt(
+	scryptInterface: IWASMInterface,
+	options: ScryptOptions,
+	input: IScryptInput,
+): string | Uint8Array {
+	const { costFactor, blockSize, parallelism, hashLength } = options;
+	const { password, salt } = input;
+
+	// memory layout: blocks, V, XY (with 64 bytes of scratch space),
+	// password, salt and the derived key
+	const inputOffset = getInputOffset(options);
+	const outputOffset = inputOffset + password.length + salt.length;
+	scryptInterface.setMemorySize(getMemorySize(options, input));
+	scryptInterface.writeMemory(password, inputOffset);
+	scryptInterface.writeMemory(salt, inputOffset + password.length);
+
+	// both PBKDF2 passes and the block mixing run inside WASM
+	scryptInterface
+		.getExports()
+		.scrypt_full(
+			password.length,
+			salt.length,
+			costFactor,
+			blockSize,
+			parallelism,
+			hashLength,
+		);
 
-	const expensiveSalt = scryptInterface
+	const outputData = scryptInterface
 		.getMemory()
-		.subarray(0, 128 * blockSize * parallelism);
-
-	const outputData = await pbkdf2({
-		password: options.password,
-		salt: expensiveSalt,
-		iterations: 1,
-		hashLength,
-		hashFunction: SHA256Hasher,
-		outputType: "binary",
-	});
+		.slice(outputOffset, outputOffset + hashLength);
 
 	if (options.outputType === "hex") {
 		const digestChars = new Uint8Array(hashLength * 2);
@@ -83,6 +110,16 @@ async function scryptInternal(
 	return outputData;
 }
 
+async function scryptInternal(
+	options: ScryptOptions,
+): Promise<string | Uint8Array> {
+	// memory sizes over 2 GiB use the memory64 build
+	const input = getInput(options);
+	const memorySize = getMemorySize(options, input);
+	const binary = selectKDFBinary(wasmJson, wasm64Json, memorySize);
+	return calculateScrypt(await WASMInterface(binary, 0), options, input);
+}
+
 const isPowerOfTwo = (v: number): boolean => v && !(v & (v - 1));
 
 const validateOptions = (options: ScryptOptions) => {
@@ -139,3 +176,44 @@ export async function scrypt<T extends ScryptOptions>(
 
 	return scryptInternal(options) as Promise<ScryptReturnType<T>>;
 }
+
+export interface IScryptEngine {
+	/**
+	 * Calculates hash using the scrypt password-based key derivation function
+	 */
+	scrypt<T extends ScryptOptions>(options: T): Promise<ScryptReturnType<T>>;
+	/**
+	 * Drops the WebAssembly instance and its memory.
+	 * The engine cannot be used afterwards
+	 */
+	dispose(): void;
+}
+
+/**
+ * Creates a scrypt engine, which reuses a single WebAssembly instance for
+ * all of its calculations instead of allocating a new memory for each one.
+ * The memory grows to the memory size of the largest calculation and it
+ * is kept until dispose() is called.
+ * @param options maxMemory limits the memory used by a calculation in bytes
+ *                (128 * blockSize * (costFactor + parallelism) bytes,
+ *                plus the password, the salt and the derived key).
+ *                Calculations with larger memory sizes are rejected
+ */
+export async function createScryptEngine(
+	options: IKDFEngineOptions = {},
+): Promise<IScryptEngine> {
+	const engine = await createKDFEngine(wasmJson, wasm64Json, 0, options);
+
+	return {
+		scrypt: async <T extends ScryptOptions>(
+			options: T,
+		): Promise<ScryptReturnType<T>> => {
+			validateOptions(options);
+			const input = getInput(options);
+			return engine.run(getMemorySize(options, input), (wasm) =>
+				calculateScrypt(wasm, options, input),
+			) as Promise<ScryptReturnType<T>>;
+		},
+		dispose: engine.dispose,
+	};
+}
@@ -1,14 +1,14 @@
 import wasmJson from "../wasm/sha256.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
+import sharedCreate from "./sharedCreate";
 import type { IDataType } from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
 /**
@@ -18,7 +18,7 @@ let wasmCache: IWASMInterface = null;
  */
 export function sha224(data: IDataType): Promise<string> {
 	if (wasmCache === null) {
-		return lockedCreate(mutex, wasmJson, 28).then((wasm) => {
+		return sharedCreate(wasmJson, 28).then((wasm) => {
 			wasmCache = wasm;
 			return wasmCache.calculate(data, 224);
 		});
@@ -32,31 +32,51 @@ export function sha224(data: IDataType): Promise<string> {
 	}
 }
 
+function createHasher(wasm: IWASMInterface): IHasher {
+	wasm.init(224);
+	const obj: IHasher = {
+		init: () => {
+			wasm.init(224);
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType, 224) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 64,
+		digestSize: 28,
+	};
+	wasm.registerNativeHmac(obj, 224);
+	return obj;
+}
+
 /**
  * Creates a new SHA-2 (SHA-224) hash instance
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createSHA224(options?: IHasherOptions): Promise<IHasher> {
+	return WASMInterface(wasmJson, 28, options).then(createHasher);
+}
+
+/**
+ * Creates a new SHA-2 (SHA-224) hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createSHA224(): Promise<IHasher> {
-	return WASMInterface(wasmJson, 28).then((wasm) => {
-		wasm.init(224);
-		const obj: IHasher = {
-			init: () => {
-				wasm.init(224);
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 64,
-			digestSize: 28,
-		};
-		return obj;
-	});
+export function createSHA224Sync(options?: IHasherOptions): IHasher {
+	return createHasher(WASMInterfaceSync(wasmJson, 28, options));
 }
@@ -0,0 +1,28 @@
+import { type IWASMInterface, WASMInterface } from "./WASMInterface";
+import type { IEmbeddedWasm } from "./util";
+
+const pendingCreates = new Map<string, Promise<IWASMInterface>>();
+
+/**
+ * Creates the instance cached by a shorthand function.
+ * Concurrent calls share a single instance instead of creating one for
+ * each call. It is safe, because the shorthand functions calculate the
+ * whole hash synchronously.
+ */
+export default function sharedCreate(
+	binary: IEmbeddedWasm,
+	hashLength: number,
+): Promise<IWASMInterface> {
+	const key = `${binary.name}:${hashLength}`;
+
+	let promise = pendingCreates.get(key);
+	if (promise === undefined) {
+		promise = WASMInterface(binary, hashLength);
+		pendingCreates.set(key, promise);
+
+		const remove = () => pendingCreates.delete(key);
+		promise.then(remove, remove);
+	}
+
+	return promise;
+}
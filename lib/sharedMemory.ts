@@ -0,0 +1,103 @@
+import { hasWASMLocation, loadWASMFile } from "./wasmLoader";
+
+// has to match SHARED_MODULES and SHARED_REGION_SIZE in scripts/Makefile-clang
+const SHARED_MODULES = [
+	"adler32",
+	"bcrypt",
+	"blake2b",
+	"blake2s",
+	"blake3",
+	"crc32",
+	"crc64",
+	"md4",
+	"md5",
+	"ripemd160",
+	"sha1",
+	"sha256",
+	"sha512",
+	"sha3",
+	"sm3",
+	"whirlpool",
+	"xxhash32",
+	"xxhash64",
+	"xxhash3",
+	"xxhash128",
+];
+const SHARED_REGION_SIZE = 128 * 1024;
+const WASM_PAGE_SIZE = 64 * 1024;
+
+let sharedMemory: WebAssembly.Memory = null;
+// null if the module could not be loaded
+const sharedModules = new Map<string, Promise<WebAssembly.Module | null>>();
+// modules, which have an instance in their region of the shared memory
+const usedRegions = new Set<string>();
+
+/**
+ * Instantiates the modules of the shared memory build (the files in the
+ * shared/ subdirectory of the WASM location) on a single WebAssembly.Memory.
+ * Every module has its own region in the memory, which is used by its first
+ * instance. Additional instances of the same algorithm, Argon2 and scrypt
+ * fall back to the regular modules with separate memories.
+ */
+export function enableSharedMemory(): void {
+	if (!hasWASMLocation()) {
+		throw new Error(
+			"The shared memory modules are loaded from files. Call setWASMLocation() first",
+		);
+	}
+
+	if (sharedMemory === null) {
+		const pages = (SHARED_MODULES.length * SHARED_REGION_SIZE) / WASM_PAGE_SIZE;
+		sharedMemory = new WebAssembly.Memory({ initial: pages, maximum: pages });
+	}
+}
+
+function validateRegion(name: string, instance: WebAssembly.Instance) {
+	// biome-ignore lint/suspicious/noExplicitAny: the exports are not typed
+	const exports = instance.exports as any;
+	const start = SHARED_MODULES.indexOf(name) * SHARED_REGION_SIZE;
+	const globalBase: number = exports.__global_base?.value;
+	const heapBase: number = exports.__heap_base?.value;
+
+	if (
+		!(globalBase >= start) ||
+		!(heapBase <= start + SHARED_REGION_SIZE) ||
+		exports.memory !== sharedMemory
+	) {
+		throw new Error(`The shared ${name} module doesn't match its region`);
+	}
+}
+
+/**
+ * Creates an instance of the module in its region of the shared memory
+ * @returns The instance or null if the shared memory cannot be used for it
+ *          (e.g. the region is used or the file cannot be loaded)
+ */
+export async function instantiateShared(
+	name: string,
+): Promise<WebAssembly.Instance> {
+	if (
+		sharedMemory === null ||
+		!SHARED_MODULES.includes(name) ||
+		usedRegions.has(name)
+	) {
+		return null;
+	}
+
+	if (!sharedModules.has(name)) {
+		sharedModules.set(name, loadWASMFile(`shared/${name}`).catch(() => null));
+	}
+
+	usedRegions.add(name);
+	const module = await sharedModules.get(name);
+	if (module === null) {
+		usedRegions.delete(name);
+		return null;
+	}
+
+	const instance = await WebAssembly.instantiate(module, {
+		env: { memory: sharedMemory },
+	});
+	validateRegion(name, instance);
+	return instance;
+}
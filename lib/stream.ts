@@ -0,0 +1,285 @@
+import { type IHasher, MAX_HEAP } from "./WASMInterface";
+import type { IDataType } from "./util";
+
+export interface IHashStreamOptions {
+	/**
+	 * Desired output type of the digest. Defaults to 'hex'
+	 */
+	outputType?: "hex" | "binary";
+	/**
+	 * Number of bytes buffered by the stream before it signals backpressure.
+	 * Defaults to 64 KiB
+	 */
+	highWaterMark?: number;
+}
+
+export const DEFAULT_HIGH_WATER_MARK = 64 * 1024;
+
+/**
+ * Collects small binary chunks into a staging buffer, so the hasher
+ * receives MAX_HEAP sized blocks instead of many tiny update() calls
+ */
+export class ChunkCoalescer {
+	private buffer: Uint8Array = null;
+
+	private length = 0;
+
+	constructor(private hasher: IHasher) {}
+
+	push(data: IDataType) {
+		if (typeof data === "string") {
+			this.flush();
+			this.hasher.update(data);
+			return;
+		}
+
+		if (!ArrayBuffer.isView(data)) {
+			throw new Error("Invalid data type!");
+		}
+
+		const chunk = new Uint8Array(
+			data.buffer,
+			data.byteOffset,
+			data.byteLength,
+		);
+
+		if (this.length + chunk.length > MAX_HEAP) {
+			this.flush();
+		}
+
+		if (chunk.length >= MAX_HEAP) {
+			this.hasher.update(chunk);
+			return;
+		}
+
+		if (this.buffer === null) {
+			this.buffer = new Uint8Array(MAX_HEAP);
+		}
+
+		this.buffer.set(chunk, this.length);
+		this.length += chunk.length;
+	}
+
+	flush() {
+		if (this.length > 0) {
+			this.hasher.update(this.buffer.subarray(0, this.length));
+			this.length = 0;
+		}
+	}
+}
+
+export function validateStreamOptions(
+	hasher: IHasher,
+	options: IHashStreamOptions,
+) {
+	if (!hasher || typeof hasher.update !== "function") {
+		throw new Error(
+			"Invalid hasher is provided! Usage: createHashSink(await createSHA256()).",
+		);
+	}
+
+	if (options.outputType === undefined) {
+		options.outputType = "hex";
+	}
+
+	if (!["hex", "binary"].includes(options.outputType)) {
+		throw new Error(
+			`Insupported output type ${options.outputType}. Valid values: ['hex', 'binary']`,
+		);
+	}
+
+	if (options.highWaterMark === undefined) {
+		options.highWaterMark = DEFAULT_HIGH_WATER_MARK;
+	}
+
+	if (!Number.isInteger(options.highWaterMark) || options.highWaterMark < 0) {
+		throw new Error("High water mark should be a non-negative integer");
+	}
+}
+
+export interface IHashSink {
+	/**
+	 * WHATWG WritableStream which feeds the written chunks into the hasher
+	 */
+	writable: WritableStream<IDataType>;
+	/**
+	 * Resolves with the digest after the writable stream is closed
+	 */
+	digest: Promise<string | Uint8Array>;
+}
+
+/**
+ * Creates a WHATWG WritableStream sink, which can be used as the target of
+ * ReadableStream.pipeTo(). The hasher is initialized when the stream starts.
+ * @param hasher Hasher instance returned by a function like createSHA256()
+ */
+export function createHashSink(
+	hasher: IHasher,
+	options: IHashStreamOptions = {},
+): IHashSink {
+	const opts = { ...options };
+	validateStreamOptions(hasher, opts);
+
+	if (typeof WritableStream === "undefined") {
+		throw new Error("WritableStream is not supported in this environment!");
+	}
+
+	const coalescer = new ChunkCoalescer(hasher);
+	let resolveDigest: (value: string | Uint8Array) => void;
+	let rejectDigest: (reason: unknown) => void;
+	const digest = new Promise<string | Uint8Array>((resolve, reject) => {
+		resolveDigest = resolve;
+		rejectDigest = reject;
+	});
+	// errors are reported through the stream as well
+	digest.catch(() => {});
+
+	const writable = new WritableStream<IDataType>(
+		{
+			start: () => {
+				hasher.init();
+			},
+			write: (chunk) => {
+				try {
+					coalescer.push(chunk);
+				} catch (err) {
+					rejectDigest(err);
+					throw err;
+				}
+			},
+			close: () => {
+				coalescer.flush();
+				resolveDigest(hasher.digest(opts.outputType as "hex"));
+			},
+			abort: (reason) => {
+				rejectDigest(reason);
+			},
+		},
+		{
+			highWaterMark: opts.highWaterMark,
+			// invalid chunks are rejected by write()
+			size: (chunk) =>
+				(typeof chunk === "string" ? chunk.length : chunk?.byteLength) || 0,
+		},
+	);
+
+	return { writable, digest };
+}
+
+export interface IHashBlobOptions {
+	/**
+	 * Desired output type of the digest. Defaults to 'hex'
+	 */
+	outputType?: "hex" | "binary";
+	/**
+	 * Number of bytes read from the blob at once. Defaults to 1 MiB
+	 */
+	chunkSize?: number;
+	/**
+	 * Called after each chunk is hashed
+	 */
+	onProgress?: (bytesHashed: number, totalBytes: number) => void;
+}
+
+const DEFAULT_BLOB_CHUNK_SIZE = 1024 * 1024;
+
+const validateBlobOptions = (
+	blob: Blob,
+	hasher: IHasher,
+	options: IHashBlobOptions,
+) => {
+	if (
+		!blob ||
+		typeof blob.size !== "number" ||
+		typeof blob.slice !== "function"
+	) {
+		throw new Error("Invalid blob is provided! It has to be a Blob or File.");
+	}
+
+	if (!hasher || typeof hasher.update !== "function") {
+		throw new Error(
+			"Invalid hasher is provided! Usage: hashBlob(file, await createSHA256()).",
+		);
+	}
+
+	if (options.outputType === undefined) {
+		options.outputType = "hex";
+	}
+
+	if (!["hex", "binary"].includes(options.outputType)) {
+		throw new Error(
+			`Insupported output type ${options.outputType}. Valid values: ['hex', 'binary']`,
+		);
+	}
+
+	if (options.chunkSize === undefined) {
+		options.chunkSize = DEFAULT_BLOB_CHUNK_SIZE;
+	}
+
+	if (!Number.isInteger(options.chunkSize) || options.chunkSize < 1) {
+		throw new Error("Chunk size should be a positive number");
+	}
+};
+
+function readBlob(blob: Blob): Promise<ArrayBuffer> {
+	if (typeof blob.arrayBuffer === "function") {
+		return blob.arrayBuffer();
+	}
+
+	// older browsers only support FileReader
+	return new Promise((resolve, reject) => {
+		const reader = new FileReader();
+		reader.onload = () => resolve(reader.result as ArrayBuffer);
+		reader.onerror = () => reject(reader.error);
+		reader.readAsArrayBuffer(blob);
+	});
+}
+
+/**
+ * Calculates the hash of a Blob or File without loading the whole content
+ * into the memory. The blob is read in slices and the next slice is read
+ * while the current one is hashed, giving control back to the event loop
+ * between the chunks.
+ * @param blob Blob or File
+ * @param hasher Hasher instance returned by a function like createSHA256()
+ * @returns Computed digest
+ */
+export async function hashBlob(
+	blob: Blob,
+	hasher: IHasher,
+	options: IHashBlobOptions = {},
+): Promise<string | Uint8Array> {
+	const opts = { ...options };
+	validateBlobOptions(blob, hasher, opts);
+
+	const { chunkSize, onProgress } = opts;
+	const totalBytes = blob.size;
+
+	hasher.init();
+
+	let position = 0;
+	let pending = readBlob(blob.slice(0, chunkSize));
+
+	try {
+		while (position < totalBytes) {
+			const chunk = new Uint8Array(await pending);
+			if (chunk.length === 0) {
+				throw new Error("Unexpected end of blob");
+			}
+			position += chunk.length;
+			if (position < totalBytes) {
+				pending = readBlob(blob.slice(position, position + chunkSize));
+			}
+
+			hasher.update(chunk);
+			if (onProgress) {
+				onProgress(position, totalBytes);
+			}
+		}
+	} finally {
+		// prevent unhandled rejections when hashing fails
+		pending.catch(() => {});
+	}
+
+	return hasher.digest(opts.outputType as "hex");
+}
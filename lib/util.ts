@@ -11,9 +11,44 @@ const textEncoder = globalObject.TextEncoder
 	? new globalObject.TextEncoder()
 	: null;
 
+function createLatin1Decoder() {
+	try {
+		return new globalObject.TextDecoder("latin1");
+	} catch {
+		return null;
+	}
+}
+
+// decodes the ASCII output of the WASM digest encoder
+const latin1Decoder = globalObject.TextDecoder ? createLatin1Decoder() : null;
+
+export function decodeLatin1(data: Uint8Array): string {
+	if (latin1Decoder !== null) {
+		return latin1Decoder.decode(data);
+	}
+	return String.fromCharCode.apply(null, data);
+}
+
+// encodes strings directly into the target buffer without temporary allocations
+export const encodeStringInto: (
+	str: string,
+	target: Uint8Array,
+) => { read?: number; written?: number } =
+	textEncoder && typeof textEncoder.encodeInto === "function"
+		? (str, target) => textEncoder.encodeInto(str, target)
+		: null;
+
 export type ITypedArray = Uint8Array | Uint16Array | Uint32Array;
 export type IDataType = string | Buffer | ITypedArray;
-export type IEmbeddedWasm = { name: string; data: string; hash: string };
+export type IEmbeddedWasm = {
+	name: string;
+	data: string;
+	hash: string;
+	/**
+	 * The module has a 64-bit memory, its sizes and pointers are BigInts
+	 */
+	memory64?: boolean;
+};
 
 export function intArrayToString(arr: Uint8Array, len: number): string {
 	return String.fromCharCode(...arr.subarray(0, len));
@@ -37,6 +72,14 @@ export function writeHexToUInt8(buf: Uint8Array, str: string) {
 	}
 }
 
+export function isHexString(str: string, byteLength: number): boolean {
+	return (
+		typeof str === "string" &&
+		str.length === byteLength * 2 &&
+		/^[0-9a-f]*$/i.test(str)
+	);
+}
+
 export function hexStringEqualsUInt8(str: string, buf: Uint8Array): boolean {
 	if (str.length !== buf.length * 2) {
 		return false;
@@ -59,9 +102,10 @@ export function getDigestHex(
 	tmpBuffer: Uint8Array,
 	input: Uint8Array,
 	hashLength: number,
+	offset = 0,
 ): string {
 	let p = 0;
-	for (let i = 0; i < hashLength; i++) {
+	for (let i = offset; i < offset + hashLength; i++) {
 		let nibble = input[i] >>> 4;
 		tmpBuffer[p++] = nibble > 9 ? nibble + alpha : nibble + digit;
 		nibble = input[i] & 0xf;
@@ -0,0 +1,86 @@
+export type IWASMLocation = string | ((fileName: string) => string);
+
+let wasmLocation: IWASMLocation = null;
+
+/**
+ * Loads the WebAssembly binaries from separate .wasm files instead of the
+ * base64 strings embedded into the JavaScript bundle. Browsers compile the
+ * files while they are downloaded and can cache the compiled code.
+ * The embedded binaries are used as a fallback if a file cannot be loaded.
+ * Modules which are already compiled are not affected.
+ * @param location URL or directory containing the .wasm files (e.g. '/assets/hash-wasm/')
+ *                 or a function which returns the location of a file by its name.
+ *                 null switches back to the embedded binaries
+ */
+export function setWASMLocation(location: IWASMLocation): void {
+	if (
+		location !== null &&
+		typeof location !== "string" &&
+		typeof location !== "function"
+	) {
+		throw new Error("WASM location should be a string or a function");
+	}
+
+	wasmLocation = location;
+}
+
+export function hasWASMLocation(): boolean {
+	return wasmLocation !== null;
+}
+
+function resolveLocation(fileName: string): string {
+	if (typeof wasmLocation === "function") {
+		return wasmLocation(fileName);
+	}
+
+	return wasmLocation.endsWith("/")
+		? `${wasmLocation}${fileName}`
+		: `${wasmLocation}/${fileName}`;
+}
+
+// process.getBuiltinModule() is used instead of an import,
+// so bundlers targeting browsers don't have to resolve node:fs
+function getNodeFS() {
+	// biome-ignore lint/suspicious/noExplicitAny: process is not typed in browsers
+	const proc = (globalThis as any).process;
+	if (typeof proc?.getBuiltinModule !== "function") {
+		return null;
+	}
+
+	return proc.getBuiltinModule("node:fs");
+}
+
+async function compileResponse(
+	response: Response,
+	location: string,
+): Promise<WebAssembly.Module> {
+	if (!response.ok) {
+		throw new Error(`Cannot load ${location} (HTTP ${response.status})`);
+	}
+
+	// streaming compilation requires the application/wasm MIME type
+	if (
+		typeof WebAssembly.compileStreaming === "function" &&
+		response.headers.get("Content-Type") === "application/wasm"
+	) {
+		return WebAssembly.compileStreaming(response);
+	}
+
+	return WebAssembly.compile(await response.arrayBuffer());
+}
+
+/**
+ * Compiles the module from the .wasm file at the configured location
+ */
+export async function loadWASMFile(name: string): Promise<WebAssembly.Module> {
+	const location = resolveLocation(`${name}.wasm`);
+
+	const fs = getNodeFS();
+	if (fs !== null && !/^https?:/i.test(location)) {
+		const path = location.startsWith("file:") ? new URL(location) : location;
+		const data: Uint8Array = await fs.promises.readFile(path);
+		return WebAssembly.compile(data);
+	}
+
+	return compileResponse(await fetch(location), location);
+}
@@ -1,14 +1,14 @@
 import wasmJson from "../wasm/xxhash128.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
+import sharedCreate from "./sharedCreate";
 import type { IDataType } from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 const seedBuffer = new Uint8Array(8);
 
@@ -51,7 +51,7 @@ export function xxhash128(
 	}
 
 	if (wasmCache === null) {
-		return lockedCreate(mutex, wasmJson, 16).then((wasm) => {
+		return sharedCreate(wasmJson, 16).then((wasm) => {
 			wasmCache = wasm;
 			writeSeed(seedBuffer.buffer, seedLow, seedHigh);
 			wasmCache.writeMemory(seedBuffer);
@@ -69,14 +69,57 @@ export function xxhash128(
 	}
 }
 
+function createHasher(
+	wasm: IWASMInterface,
+	seedLow: number,
+	seedHigh: number,
+): IHasher {
+	const instanceBuffer = new Uint8Array(8);
+	writeSeed(instanceBuffer.buffer, seedLow, seedHigh);
+	wasm.writeMemory(instanceBuffer);
+	wasm.init();
+	const obj: IHasher = {
+		init: () => {
+			wasm.writeMemory(instanceBuffer);
+			wasm.init();
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 512,
+		digestSize: 16,
+	};
+	return obj;
+}
+
 /**
  * Creates a new xxHash128 hash instance
  * @param seedLow Lower 32 bits of the number used to
  *  initialize the internal state of the algorithm (defaults to 0)
  * @param seedHigh Higher 32 bits of the number used to
  *  initialize the internal state of the algorithm (defaults to 0)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createXXHash128(seedLow = 0, seedHigh = 0): Promise<IHasher> {
+export function createXXHash128(
+	seedLow = 0,
+	seedHigh = 0,
+	options?: IHasherOptions,
+): Promise<IHasher> {
 	if (validateSeed(seedLow)) {
 		return Promise.reject(validateSeed(seedLow));
 	}
@@ -85,31 +128,37 @@ export function createXXHash128(seedLow = 0, seedHigh = 0): Promise<IHasher> {
 		return Promise.reject(validateSeed(seedHigh));
 	}
 
-	return WASMInterface(wasmJson, 16).then((wasm) => {
-		const instanceBuffer = new Uint8Array(8);
-		writeSeed(instanceBuffer.buffer, seedLow, seedHigh);
-		wasm.writeMemory(instanceBuffer);
-		wasm.init();
-		const obj: IHasher = {
-			init: () => {
-				wasm.writeMemory(instanceBuffer);
-				wasm.init();
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 512,
-			digestSize: 16,
-		};
-		return obj;
-	});
+	return WASMInterface(wasmJson, 16, options).then((wasm) =>
+		createHasher(wasm, seedLow, seedHigh),
+	);
+}
+
+/**
+ * Creates a new xxHash128 hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param seedLow Lower 32 bits of the number used to
+ *  initialize the internal state of the algorithm (defaults to 0)
+ * @param seedHigh Higher 32 bits of the number used to
+ *  initialize the internal state of the algorithm (defaults to 0)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createXXHash128Sync(
+	seedLow = 0,
+	seedHigh = 0,
+	options?: IHasherOptions,
+): IHasher {
+	if (validateSeed(seedLow)) {
+		throw validateSeed(seedLow);
+	}
+
+	if (validateSeed(seedHigh)) {
+		throw validateSeed(seedHigh);
+	}
+
+	return createHasher(
+		WASMInterfaceSync(wasmJson, 16, options),
+		seedLow,
+		seedHigh,
+	);
 }
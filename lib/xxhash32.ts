@@ -1,14 +1,14 @@
 import wasmJson from "../wasm/xxhash32.wasm.json";
 import {
 	type IHasher,
+	type IHasherOptions,
 	type IWASMInterface,
 	WASMInterface,
+	WASMInterfaceSync,
 } from "./WASMInterface";
-import lockedCreate from "./lockedCreate";
-import Mutex from "./mutex";
+import sharedCreate from "./sharedCreate";
 import type { IDataType } from "./util";
 
-const mutex = new Mutex();
 let wasmCache: IWASMInterface = null;
 
 function validateSeed(seed: number) {
@@ -29,7 +29,7 @@ export function xxhash32(data: IDataType, seed = 0): Promise<string> {
 	}
 
 	if (wasmCache === null) {
-		return lockedCreate(mutex, wasmJson, 4).then((wasm) => {
+		return sharedCreate(wasmJson, 4).then((wasm) => {
 			wasmCache = wasm;
 			return wasmCache.calculate(data, seed);
 		});
@@ -43,37 +43,70 @@ export function xxhash32(data: IDataType, seed = 0): Promise<string> {
 	}
 }
 
+function createHasher(wasm: IWASMInterface, seed: number): IHasher {
+	wasm.init(seed);
+	const obj: IHasher = {
+		init: () => {
+			wasm.init(seed);
+			return obj;
+		},
+		update: (data) => {
+			wasm.update(data);
+			return obj;
+		},
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		digest: (outputType) => wasm.digest(outputType) as any,
+		digestInto: (target, offset) => wasm.digestInto(target, offset),
+		// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
+		hashMany: (messages, outputType) =>
+			wasm.calculateMany(obj, messages, outputType, seed) as any,
+		save: () => wasm.save(),
+		load: (data) => {
+			wasm.load(data);
+			return obj;
+		},
+		release: () => wasm.release(),
+		blockSize: 16,
+		digestSize: 4,
+	};
+	return obj;
+}
+
 /**
  * Creates a new xxHash32 hash instance
  * @param data Input data (string, Buffer or TypedArray)
  * @param seed Number used to initialize the internal state of the algorithm (defaults to 0)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
  */
-export function createXXHash32(seed = 0): Promise<IHasher> {
+export function createXXHash32(
+	seed = 0,
+	options?: IHasherOptions,
+): Promise<IHasher> {
 	if (validateSeed(seed)) {
 		return Promise.reject(validateSeed(seed));
 	}
 
-	return WASMInterface(wasmJson, 4).then((wasm) => {
-		wasm.init(seed);
-		const obj: IHasher = {
-			init: () => {
-				wasm.init(seed);
-				return obj;
-			},
-			update: (data) => {
-				wasm.update(data);
-				return obj;
-			},
-			// biome-ignore lint/suspicious/noExplicitAny: Conflict with IHasher type
-			digest: (outputType) => wasm.digest(outputType) as any,
-			save: () => wasm.save(),
-			load: (data) => {
-				wasm.load(data);
-				return obj;
-			},
-			blockSize: 16,
-			digestSize: 4,
-		};
-		return obj;
-	});
+	return WASMInterface(wasmJson, 4, options).then((wasm) =>
+		createHasher(wasm, seed),
+	);
+}
+
+/**
+ * Creates a new xxHash32 hash instance synchronously.
+ * The WASM module is compiled on the first call, unless it was preloaded
+ * @param data Input data (string, Buffer or TypedArray)
+ * @param seed Number used to initialize the internal state of the algorithm (defaults to 0)
+ * @param options Hasher options, e.g. { pooled: true } to reuse the
+ *                WebAssembly instances of released hashers
+ */
+export function createXXHash32Sync(
+	seed = 0,
+	options?: IHasherOptions,
+): IHasher {
+	if (validateSeed(seed)) {
+		throw validateSeed(seed);
+	}
+
+	return createHasher(WASMInterfaceSync(wasmJson, 4, options), seed);
 }
@@ -49,6 +49,20 @@ const LICENSE_CONFIG = {
   },
 };
 
+// drops the embedded binaries, the .wasm files are loaded
+// at runtime from the location given to setWASMLocation()
+const externalWasm = () => ({
+  name: "external-wasm",
+  transform(code, id) {
+    if (!id.endsWith(".wasm.json")) {
+      return null;
+    }
+
+    const { name, hash } = JSON.parse(code);
+    return { code: JSON.stringify({ name, hash, data: "" }), map: null };
+  },
+});
+
 const MAIN_BUNDLE_CONFIG = {
   input: "lib/index.ts",
   output: [
@@ -86,6 +100,44 @@ const MINIFIED_MAIN_BUNDLE_CONFIG = {
   ],
 };
 
+const EXTERNAL_WASM_BUNDLE_CONFIG = {
+  input: "lib/index.ts",
+  output: [
+    {
+      file: "dist/index.external.umd.min.js",
+      name: "hashwasm",
+      format: "umd",
+    },
+    {
+      file: "dist/index.external.esm.min.js",
+      format: "es",
+    },
+  ],
+  plugins: [
+    externalWasm(),
+    json(),
+    typescript(),
+    terser(TERSER_CONFIG),
+    license(LICENSE_CONFIG),
+  ],
+};
+
+const NODE_BUNDLE_CONFIG = {
+  input: "lib/node.ts",
+  output: [
+    {
+      file: "dist/node.cjs.js",
+      format: "cjs",
+    },
+    {
+      file: "dist/node.esm.js",
+      format: "es",
+    },
+  ],
+  external: [/^node:/],
+  plugins: [json(), typescript(), license(LICENSE_CONFIG)],
+};
+
 const INDIVIDUAL_BUNDLE_CONFIG = (algorithm) => ({
   input: `lib/${algorithm}.ts`,
   output: [
@@ -108,5 +160,7 @@ const INDIVIDUAL_BUNDLE_CONFIG = (algorithm) => ({
 export default [
   MAIN_BUNDLE_CONFIG,
   MINIFIED_MAIN_BUNDLE_CONFIG,
+  EXTERNAL_WASM_BUNDLE_CONFIG,
+  NODE_BUNDLE_CONFIG,
   ...ALGORITHMS.map(INDIVIDUAL_BUNDLE_CONFIG),
 ];
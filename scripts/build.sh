@@ -22,7 +22,7 @@ docker run \
   -v hash-wasm-volume:/app \
   -u $(id -u):$(id -g) \
   clang:hash-wasm \
-  make -f /app/scripts/Makefile-clang --silent --always-make --output-sync=target -j8 all
+  make -f /app/scripts/Makefile-clang --silent --always-make --output-sync=target -j8 all shared
 
 # copy output back
 docker cp hash-wasm-temp:/app/wasm/ .
@@ -31,7 +31,11 @@ docker volume rm hash-wasm-volume
 
 # node scripts/optimize
 node scripts/make_json
+# the .wasm files are loaded by the external bundles
+mkdir -p dist/wasm
+cp wasm/*.wasm dist/wasm/
+cp -r wasm/shared dist/wasm/
 node --max-old-space-size=4096 ./node_modules/rollup/dist/bin/rollup -c
-npx tsc ./lib/index --outDir ./dist --downlevelIteration --emitDeclarationOnly --declaration --resolveJsonModule --allowSyntheticDefaultImports
+npx tsc ./lib/index ./lib/node --outDir ./dist --downlevelIteration --emitDeclarationOnly --declaration --resolveJsonModule --allowSyntheticDefaultImports
 
 #-s ASSERTIONS=1 \
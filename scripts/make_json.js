@@ -5,6 +5,33 @@ const crypto = require("node:crypto");
 const dir = path.resolve(__dirname, "..", "wasm");
 const files = fs.readdirSync(dir).filter((file) => file.endsWith(".wasm"));
 
+function readLEB128(data, state) {
+  let result = 0;
+  let shift = 0;
+  let byte;
+  do {
+    byte = data[state.offset++];
+    result += (byte & 0x7f) * 2 ** shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return result;
+}
+
+// memory64 modules have the 0x04 flag set on the limits of their memory
+function isMemory64(data) {
+  const state = { offset: 8 };
+  while (state.offset < data.length) {
+    const id = data[state.offset++];
+    const size = readLEB128(data, state);
+    if (id === 5) {
+      const count = readLEB128(data, state);
+      return count > 0 && (data[state.offset] & 0x04) !== 0;
+    }
+    state.offset += size;
+  }
+  return false;
+}
+
 for (const file of files) {
   const data = fs.readFileSync(path.join(dir, file));
   const base64Data = data.toString("base64");
@@ -20,6 +47,7 @@ for (const file of files) {
     name: parsedName.name,
     data: base64Data,
     hash,
+    ...(isMemory64(data) ? { memory64: true } : {}),
   });
 
   fs.writeFileSync(path.join(dir, `${file}.json`), json);
@@ -135,9 +135,47 @@ uint8_t* Hash_GetState() {
   return (uint8_t*) &previousAdler;
 }
 
+/**
+ * Combines the checksums of two consecutive parts stored in main_buffer
+ * (in the byte order of Hash_Final()) into the checksum of the whole data,
+ * same as zlib's adler32_combine(). The length of the second part is split
+ * into two 32-bit halves. The result is written to the start of main_buffer.
+ */
+WASM_EXPORT
+void Hash_Combine(uint32_t lengthLow, uint32_t lengthHigh) {
+  uint32_t adler1 = bswap_32(((uint32_t*)main_buffer)[0]);
+  uint32_t adler2 = bswap_32(((uint32_t*)main_buffer)[1]);
+  uint64_t len2 = ((uint64_t)lengthHigh << 32) | lengthLow;
+
+  MOD63(len2);                /* assumes len2 >= 0 */
+  uint32_t rem = (uint32_t)len2;
+  uint32_t sum1 = adler1 & 0xffff;
+  uint32_t sum2 = rem * sum1;
+  MOD(sum2);
+  sum1 += (adler2 & 0xffff) + BASE - 1;
+  sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + BASE - rem;
+  if (sum1 >= BASE) sum1 -= BASE;
+  if (sum1 >= BASE) sum1 -= BASE;
+  if (sum2 >= ((uint32_t)BASE << 1)) sum2 -= ((uint32_t)BASE << 1);
+  if (sum2 >= BASE) sum2 -= BASE;
+
+  ((uint32_t*)main_buffer)[0] = bswap_32(sum1 | (sum2 << 16));
+}
+
 WASM_EXPORT
 void Hash_Calculate(uint32_t length) {
   Hash_Init();
   Hash_Update(length);
   Hash_Final();
 }
+
+static void calculate_one(uint32_t length, uint32_t initParam,
+                          uint32_t finalParam) {
+  Hash_Calculate(length);
+}
+
+WASM_EXPORT
+void Hash_CalculateMany(uint32_t count, uint32_t digestLength,
+                        uint32_t initParam, uint32_t finalParam) {
+  calculate_many(count, digestLength, initParam, finalParam, calculate_one);
+}
@@ -12,11 +12,11 @@ uint8_t *B = NULL;
 uint64_t B_size = 0;
 
 WASM_EXPORT
-int8_t Hash_SetMemorySize(uint32_t total_bytes) {
-  uint32_t bytes_required = total_bytes - B_size;
-
-  if (bytes_required > 0) {
-    uint32_t blocks = bytes_required / BYTES_PER_PAGE;
+int8_t Hash_SetMemorySize(uintptr_t total_bytes) {
+  // the memory cannot shrink, reused instances keep the grown memory
+  if (total_bytes > B_size) {
+    uintptr_t bytes_required = total_bytes - B_size;
+    uintptr_t blocks = bytes_required / BYTES_PER_PAGE;
     if (blocks * BYTES_PER_PAGE < bytes_required) {
       blocks += 1;
     }
@@ -48,6 +48,161 @@ static __inline__ uint64_t rotr64(const uint64_t w, const unsigned c) {
   return (w >> c) | (w << (64 - c));
 }
 
+/* Unkeyed BLAKE2b, used for H0, H' and the initial blocks */
+
+typedef struct {
+  uint64_t h[8];
+  uint64_t t;
+  uint8_t buf[128];
+  uint32_t buflen;
+  uint32_t outlen;
+} blake2b_ctx;
+
+static const uint64_t blake2b_IV[8] = {
+  0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+  0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+  0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+  0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint8_t blake2b_sigma[12][16] = {
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+  { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+  {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+  {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+  {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+  { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+  { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+  {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+  { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13 , 0 },
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+#define BLAKE2B_G(r, i, a, b, c, d)             \
+  do {                                          \
+    a = a + b + m[blake2b_sigma[r][2 * i + 0]]; \
+    d = rotr64(d ^ a, 32);                      \
+    c = c + d;                                  \
+    b = rotr64(b ^ c, 24);                      \
+    a = a + b + m[blake2b_sigma[r][2 * i + 1]]; \
+    d = rotr64(d ^ a, 16);                      \
+    c = c + d;                                  \
+    b = rotr64(b ^ c, 63);                      \
+  } while (0)
+
+static void blake2b_compress(blake2b_ctx *ctx, const uint8_t *block,
+                             uint64_t last) {
+  uint64_t m[16];
+  uint64_t v[16];
+
+  for (int i = 0; i < 16; i++) {
+    m[i] = *(uint64_t *)(block + i * 8);
+  }
+
+  for (int i = 0; i < 8; i++) {
+    v[i] = ctx->h[i];
+    v[i + 8] = blake2b_IV[i];
+  }
+  v[12] ^= ctx->t;
+  v[14] ^= last;
+
+  for (int r = 0; r < 12; r++) {
+    BLAKE2B_G(r, 0, v[0], v[4], v[8], v[12]);
+    BLAKE2B_G(r, 1, v[1], v[5], v[9], v[13]);
+    BLAKE2B_G(r, 2, v[2], v[6], v[10], v[14]);
+    BLAKE2B_G(r, 3, v[3], v[7], v[11], v[15]);
+    BLAKE2B_G(r, 4, v[0], v[5], v[10], v[15]);
+    BLAKE2B_G(r, 5, v[1], v[6], v[11], v[12]);
+    BLAKE2B_G(r, 6, v[2], v[7], v[8], v[13]);
+    BLAKE2B_G(r, 7, v[3], v[4], v[9], v[14]);
+  }
+
+  for (int i = 0; i < 8; i++) {
+    ctx->h[i] ^= v[i] ^ v[i + 8];
+  }
+}
+
+#undef BLAKE2B_G
+
+static void blake2b_init(blake2b_ctx *ctx, uint32_t outlen) {
+  for (int i = 0; i < 8; i++) {
+    ctx->h[i] = blake2b_IV[i];
+  }
+  // digest length, fanout = 1, depth = 1
+  ctx->h[0] ^= 0x01010000 ^ outlen;
+  ctx->t = 0;
+  ctx->buflen = 0;
+  ctx->outlen = outlen;
+}
+
+static void blake2b_update(blake2b_ctx *ctx, const uint8_t *in,
+                           uint32_t inlen) {
+  while (inlen > 0) {
+    if (ctx->buflen == 128) {
+      ctx->t += 128;
+      blake2b_compress(ctx, ctx->buf, 0);
+      ctx->buflen = 0;
+    }
+
+    // full blocks are compressed without copying, except the last one
+    if (ctx->buflen == 0 && inlen > 128) {
+      ctx->t += 128;
+      blake2b_compress(ctx, in, 0);
+      in += 128;
+      inlen -= 128;
+      continue;
+    }
+
+    ctx->buf[ctx->buflen++] = *in++;
+    inlen--;
+  }
+}
+
+static void blake2b_update32(blake2b_ctx *ctx, uint32_t value) {
+  uint8_t le[4] = {value, value >> 8, value >> 16, value >> 24};
+  blake2b_update(ctx, le, 4);
+}
+
+static void blake2b_final(blake2b_ctx *ctx, uint8_t *out) {
+  ctx->t += ctx->buflen;
+  memset(ctx->buf + ctx->buflen, 0, 128 - ctx->buflen);
+  blake2b_compress(ctx, ctx->buf, (uint64_t)-1);
+  memcpy(out, ctx->h, ctx->outlen);
+}
+
+/* Variable-length hash function H' */
+static void blake2b_long(uint8_t *out, uint32_t outlen, const uint8_t *in,
+                         uint32_t inlen) {
+  blake2b_ctx ctx;
+  alignas(8) uint8_t v[64];
+
+  blake2b_init(&ctx, outlen <= 64 ? outlen : 64);
+  blake2b_update32(&ctx, outlen);
+  blake2b_update(&ctx, in, inlen);
+
+  if (outlen <= 64) {
+    blake2b_final(&ctx, out);
+    return;
+  }
+
+  uint32_t r = (outlen + 31) / 32 - 2;
+  blake2b_final(&ctx, v);
+  memcpy(out, v, 32);
+
+  for (uint32_t i = 1; i < r; i++) {
+    blake2b_init(&ctx, 64);
+    blake2b_update(&ctx, v, 64);
+    blake2b_final(&ctx, v);
+    memcpy(out + i * 32, v, 32);
+  }
+
+  blake2b_init(&ctx, outlen - 32 * r);
+  blake2b_update(&ctx, v, 64);
+  blake2b_final(&ctx, out + r * 32);
+}
+
 #define G(a, b, c, d)                                    \
   do {                                                   \
     a = a + b + 2 * (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF); \
@@ -153,19 +308,8 @@ uint64_t addresses[128];
 uint64_t zero[128];
 uint64_t in[128];
 
-WASM_EXPORT
-void Hash_Calculate(uint32_t length, uint32_t memorySize) {
-  uint32_t *initVector = (uint32_t *)(B + 1024 * memorySize);
-  uint32_t parallelism = initVector[0];
-  uint32_t hashLength = initVector[1];
-  uint32_t memorySize2 = initVector[2];
-  uint32_t iterations = initVector[3];
-  uint32_t version = initVector[4];
-  uint32_t hashType = initVector[5];
-  if (memorySize2 != memorySize) {
-    return;
-  }
-
+static void fill_memory(uint32_t memorySize, uint32_t parallelism,
+                        uint32_t iterations, uint32_t hashType) {
   uint32_t segments = memorySize / (parallelism * 4);
   memorySize = segments * parallelism * 4;
   uint32_t lanes = segments * 4;
@@ -206,14 +350,14 @@ void Hash_Calculate(uint32_t length, uint32_t memorySize) {
             }
             rand = addresses[index % 128];
           } else {
-            rand = *(uint64_t *)(B + prev * 1024);
+            rand = *(uint64_t *)(B + (uintptr_t)prev * 1024);
           }
           uint32_t newOffset = indexAlpha(rand, lanes, segments, parallelism, k, slice, lane, index);
 
           block(
-            (uint64_t *)&B[offset * 1024],
-            (uint64_t *)&B[prev * 1024],
-            (uint64_t *)&B[newOffset * 1024],
+            (uint64_t *)&B[(uintptr_t)offset * 1024],
+            (uint64_t *)&B[(uintptr_t)prev * 1024],
+            (uint64_t *)&B[(uintptr_t)newOffset * 1024],
             1
           );
           index++;
@@ -223,9 +367,10 @@ void Hash_Calculate(uint32_t length, uint32_t memorySize) {
     }
   }
 
-  uint32_t destIndex = (memorySize - 1) * 1024;
+  // byte offsets can exceed 4 GiB in the wasm64 build
+  uintptr_t destIndex = (uintptr_t)(memorySize - 1) * 1024;
   for (uint32_t lane = 0; lane < parallelism - 1; lane++) {
-    uint32_t sourceIndex = (lane * lanes + lanes - 1) * 1024;
+    uintptr_t sourceIndex = (uintptr_t)(lane * lanes + lanes - 1) * 1024;
     for (uint32_t i = 0; i < 1024; i += 8) {
       *(uint64_t *)&B[destIndex + i] ^= *(uint64_t *)&B[sourceIndex + i];
     }
@@ -235,3 +380,49 @@ void Hash_Calculate(uint32_t length, uint32_t memorySize) {
     *(uint64_t *)&B[i] = *(uint64_t *)&B[destIndex + i];
   }
 }
+
+/**
+ * Calculates the whole Argon2 hash.
+ * The input of H0 is read from the end of the memory blocks (B + memorySize KiB):
+ * parallelism, hashLength, memorySize, iterations, version, hashType as
+ * 32-bit values, followed by the length-prefixed password, salt, secret and
+ * associated data.
+ * The tag is written to the start of B.
+ *
+ * @param length length of the H0 input in bytes
+ * @param memorySize number of 1 KiB memory blocks
+ */
+WASM_EXPORT
+void Hash_Calculate(uint32_t length, uint32_t memorySize) {
+  uint8_t *input = B + (uintptr_t)memorySize * 1024;
+  uint32_t *initVector = (uint32_t *)input;
+  uint32_t parallelism = initVector[0];
+  uint32_t hashLength = initVector[1];
+  uint32_t memorySize2 = initVector[2];
+  uint32_t iterations = initVector[3];
+  uint32_t hashType = initVector[5];
+  if (memorySize2 != memorySize) {
+    return;
+  }
+
+  // H0 || LE32(block index) || LE32(lane)
+  alignas(8) uint8_t param[72];
+  blake2b_ctx ctx;
+  blake2b_init(&ctx, 64);
+  blake2b_update(&ctx, input, length);
+  blake2b_final(&ctx, param);
+
+  uint32_t lanes = memorySize / (parallelism * 4) * 4;
+  for (uint32_t lane = 0; lane < parallelism; lane++) {
+    for (uint32_t i = 0; i < 2; i++) {
+      *(uint32_t *)(param + 64) = i;
+      *(uint32_t *)(param + 68) = lane;
+      blake2b_long(B + (uintptr_t)(lane * lanes + i) * 1024, 1024, param, 72);
+    }
+  }
+
+  fill_memory(memorySize, parallelism, iterations, hashType);
+
+  // the final block is at the start of B, the tag overwrites it
+  blake2b_long(B, hashLength, B, 1024);
+}
@@ -296,3 +296,16 @@ void Hash_Calculate(uint32_t length, uint32_t initParam) {
   Hash_Update(length);
   Hash_Final();
 }
+
+static void calculate_one(uint32_t length, uint32_t initParam,
+                          uint32_t finalParam) {
+  Hash_Calculate(length, initParam);
+}
+
+WASM_EXPORT
+void Hash_CalculateMany(uint32_t count, uint32_t digestLength,
+                        uint32_t initParam, uint32_t finalParam) {
+  calculate_many(count, digestLength, initParam, finalParam, calculate_one);
+}
+
+WITH_HMAC(Hash_Init(initParam), Hash_Final())
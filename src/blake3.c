@@ -21,6 +21,8 @@
 #define BLAKE3_MAX_DEPTH 54
 #define MAX_SIMD_DEGREE 1
 #define MAX_SIMD_DEGREE_OR_2 (MAX_SIMD_DEGREE > 2 ? MAX_SIMD_DEGREE : 2)
+// Hash_ChunkCVs() hashes every chunk of main_buffer in a single call
+#define MAX_PARALLEL_CHUNKS (MAIN_BUFFER_SIZE / BLAKE3_CHUNK_LEN)
 #define bool uint8_t
 #define true 1
 #define false 0
@@ -75,6 +77,8 @@ typedef struct {
   // don't know whether more input is coming. This is different from how the
   // reference implementation does things.
   uint8_t cv_stack[(BLAKE3_MAX_DEPTH + 1) * BLAKE3_OUT_LEN];
+  // chunk counter of the first chunk, when hashing a subtree of a larger tree
+  uint64_t chunk_offset;
 } blake3_hasher;
 
 /* Find index of the highest set bit */
@@ -304,6 +308,16 @@ static __inline__ void output_root_bytes(
   size_t offset_within_block = seek % 64;
   uint8_t wide_buf[64];
   while (out_len > 0) {
+    if (offset_within_block == 0 && out_len >= 64) {
+      // whole blocks are written directly to the output
+      blake3_compress_xof_portable(
+        self->input_cv, self->block, self->block_len, output_block_counter, self->flags | ROOT, out
+      );
+      out += 64;
+      out_len -= 64;
+      output_block_counter += 1;
+      continue;
+    }
     blake3_compress_xof_portable(
       self->input_cv, self->block, self->block_len, output_block_counter, self->flags | ROOT, wide_buf
     );
@@ -414,6 +428,7 @@ void blake3_hash_many_portable(
 }
 
 // Use SIMD parallelism to hash up to MAX_SIMD_DEGREE chunks at the same time
+// (or up to MAX_PARALLEL_CHUNKS chunks of main_buffer, one after the other)
 // on a single thread. Write out the chunk chaining values and return the
 // number of chunks hashed. These chunks are never the root and never empty;
 // those cases use a different codepath.
@@ -421,7 +436,7 @@ static __inline__ size_t compress_chunks_parallel(
   const uint8_t *input, size_t input_len, const uint32_t key[8],
   uint64_t chunk_counter, uint8_t flags, uint8_t *out
 ) {
-  const uint8_t *chunks_array[MAX_SIMD_DEGREE];
+  const uint8_t *chunks_array[MAX_PARALLEL_CHUNKS];
   size_t input_position = 0;
   size_t chunks_array_len = 0;
   while (input_len - input_position >= BLAKE3_CHUNK_LEN) {
@@ -598,6 +613,7 @@ static __inline__ void hasher_init_base(blake3_hasher *self, const uint32_t key[
   memcpy32(self->key, key);
   chunk_state_init(&self->chunk, key, flags);
   self->cv_stack_len = 0;
+  self->chunk_offset = 0;
 }
 
 void blake3_hasher_init(blake3_hasher *self) {
@@ -621,7 +637,7 @@ void blake3_hasher_init_keyed(blake3_hasher *self, const uint8_t key[BLAKE3_KEY_
 // stack. The principle is the same: each CV that should remain in the stack is
 // represented by a 1-bit in the total number of chunks (or bytes) so far.
 static __inline__ void hasher_merge_cv_stack(blake3_hasher *self, uint64_t total_len) {
-  size_t post_merge_stack_len = (size_t)popcnt(total_len);
+  size_t post_merge_stack_len = (size_t)popcnt(total_len - self->chunk_offset);
   while (self->cv_stack_len > post_merge_stack_len) {
     uint8_t *parent_node =
       &self->cv_stack[(self->cv_stack_len - 2) * BLAKE3_OUT_LEN];
@@ -781,22 +797,12 @@ void blake3_hasher_update(blake3_hasher *self, const void *input, size_t input_l
   }
 }
 
-void blake3_hasher_finalize_seek(
-  const blake3_hasher *self, uint64_t seek, uint8_t *out, size_t out_len
-) {
-  // Explicitly checking for zero avoids causing UB by passing a null pointer
-  // to memcpy. This comes up in practice with things like:
-  //   std::vector<uint8_t> v;
-  //   blake3_hasher_finalize(&hasher, v.data(), v.size());
-  if (out_len == 0) {
-    return;
-  }
-
+// Returns the output of the top node of the tree, which is finalized either
+// as the root or as the chaining value of a subtree.
+static output_t hasher_final_output(const blake3_hasher *self) {
   // If the subtree stack is empty, then the current chunk is the root.
   if (self->cv_stack_len == 0) {
-    output_t output = chunk_state_output(&self->chunk);
-    output_root_bytes(&output, seek, out, out_len);
-    return;
+    return chunk_state_output(&self->chunk);
   }
   // If there are any bytes in the chunk state, finalize that chunk and do a
   // roll-up merge between that chunk hash and every subtree in the stack. In
@@ -822,6 +828,21 @@ void blake3_hasher_finalize_seek(
     output_chaining_value(&output, &parent_block[32]);
     output = parent_output(parent_block, self->key, self->chunk.flags);
   }
+  return output;
+}
+
+void blake3_hasher_finalize_seek(
+  const blake3_hasher *self, uint64_t seek, uint8_t *out, size_t out_len
+) {
+  // Explicitly checking for zero avoids causing UB by passing a null pointer
+  // to memcpy. This comes up in practice with things like:
+  //   std::vector<uint8_t> v;
+  //   blake3_hasher_finalize(&hasher, v.data(), v.size());
+  if (out_len == 0) {
+    return;
+  }
+
+  output_t output = hasher_final_output(self);
   output_root_bytes(&output, seek, out, out_len);
 }
 
@@ -831,10 +852,34 @@ void blake3_hasher_finalize(const blake3_hasher *self, uint8_t *out, size_t out_
 
 blake3_hasher hasher;
 
+// hashed context strings of the derive_key mode, selected by the
+// init parameter DERIVE_KEY_PARAM + slot
+#define DERIVE_KEY_PARAM 256
+#define DERIVE_KEY_SLOTS 16
+uint32_t derive_key_contexts[DERIVE_KEY_SLOTS][8];
+
+/**
+ * Hashes the context string stored in main_buffer and keeps the resulting
+ * context key in the given slot, so the derivations with the same context
+ * only hash their key material.
+ */
+WASM_EXPORT
+void Hash_SetDeriveKeyContext(uint32_t slot, uint32_t length) {
+  blake3_hasher context_hasher;
+  hasher_init_base(&context_hasher, IV, DERIVE_KEY_CONTEXT);
+  blake3_hasher_update(&context_hasher, main_buffer, length);
+  uint8_t context_key[BLAKE3_KEY_LEN];
+  blake3_hasher_finalize(&context_hasher, context_key, BLAKE3_KEY_LEN);
+  load_key_words(context_key, derive_key_contexts[slot % DERIVE_KEY_SLOTS]);
+}
+
 WASM_EXPORT
 void Hash_Init(uint32_t keyLen) {
   if (keyLen == 32) {
     blake3_hasher_init_keyed(&hasher, main_buffer);
+  } else if (keyLen >= DERIVE_KEY_PARAM) {
+    uint32_t slot = (keyLen - DERIVE_KEY_PARAM) % DERIVE_KEY_SLOTS;
+    hasher_init_base(&hasher, derive_key_contexts[slot], DERIVE_KEY_MATERIAL);
   } else {
     blake3_hasher_init(&hasher);
   }
@@ -859,9 +904,121 @@ uint8_t* Hash_GetState() {
   return (uint8_t*) &hasher;
 }
 
+/**
+ * Calculates the chaining values of the chunks stored in main_buffer. The
+ * first chunk has the given chunk counter, which is split into two 32-bit
+ * halves. The 32-byte chaining values are written to the start of
+ * main_buffer. If isRoot is set, the data is a single chunk, which is the
+ * root of the tree, and its root hash is written instead.
+ */
+WASM_EXPORT
+void Hash_ChunkCVs(uint32_t length, uint32_t counterLow, uint32_t counterHigh,
+                   uint32_t isRoot) {
+  uint64_t counter = ((uint64_t)counterHigh << 32) | counterLow;
+  if (isRoot) {
+    blake3_chunk_state chunk_state;
+    chunk_state_init(&chunk_state, IV, 0);
+    chunk_state_update(&chunk_state, main_buffer, length);
+    output_t output = chunk_state_output(&chunk_state);
+    output_root_bytes(&output, 0, main_buffer, BLAKE3_OUT_LEN);
+    return;
+  }
+
+  uint8_t cvs[MAX_PARALLEL_CHUNKS * BLAKE3_OUT_LEN];
+  size_t count = compress_chunks_parallel(main_buffer, length, IV, counter, 0, cvs);
+  memcpy(main_buffer, cvs, count * BLAKE3_OUT_LEN);
+}
+
+/**
+ * Calculates the parent chaining values of count pairs of chaining values
+ * stored in main_buffer. The results are written to the start of
+ * main_buffer. If isRoot is set, the single pair is the root of the tree,
+ * and its root hash is written instead.
+ */
+WASM_EXPORT
+void Hash_ParentCVs(uint32_t count, uint32_t isRoot) {
+  for (uint32_t i = 0; i < count; i++) {
+    output_t output = parent_output(&main_buffer[i * BLAKE3_BLOCK_LEN], IV, 0);
+    if (isRoot) {
+      output_root_bytes(&output, 0, main_buffer, BLAKE3_OUT_LEN);
+    } else {
+      output_chaining_value(&output, &main_buffer[i * BLAKE3_OUT_LEN]);
+    }
+  }
+}
+
+/**
+ * Starts hashing a subtree, whose first chunk has the given chunk counter
+ * (split into two 32-bit halves). The counter has to be a multiple of the
+ * subtree size rounded up to a power of two chunks.
+ */
+WASM_EXPORT
+void Hash_InitSubtree(uint32_t counterLow, uint32_t counterHigh) {
+  uint64_t counter = ((uint64_t)counterHigh << 32) | counterLow;
+  blake3_hasher_init(&hasher);
+  hasher.chunk.chunk_counter = counter;
+  hasher.chunk_offset = counter;
+}
+
+/* Writes the chaining value of the hashed subtree to main_buffer. */
+WASM_EXPORT
+void Hash_FinalSubtree() {
+  output_t output = hasher_final_output(&hasher);
+  output_chaining_value(&output, main_buffer);
+}
+
+/**
+ * Pushes the chaining value of a subtree stored in main_buffer to the
+ * hasher. The subtrees have to be pushed in order, the counter is the chunk
+ * counter of the first chunk of the subtree. The root is calculated by
+ * Hash_Final() after pushing at least two subtrees.
+ */
+WASM_EXPORT
+void Hash_PushSubtree(uint32_t counterLow, uint32_t counterHigh) {
+  uint64_t counter = ((uint64_t)counterHigh << 32) | counterLow;
+  hasher_push_cv(&hasher, main_buffer, counter);
+}
+
+// state of the extendable output reader, a copy of the finalized hasher
+blake3_hasher xof_hasher;
+
+/* Copies the hasher into the state of the reader and returns its size. */
+WASM_EXPORT
+uint32_t Hash_StartXOF() {
+  xof_hasher = hasher;
+  return sizeof(xof_hasher);
+}
+
+WASM_EXPORT
+uint8_t* Hash_GetXOFState() {
+  return (uint8_t*) &xof_hasher;
+}
+
+/**
+ * Writes length bytes of extendable output to main_buffer, starting at the
+ * given position of the output stream. The position is split into two
+ * 32-bit halves.
+ */
+WASM_EXPORT
+void Hash_Squeeze(uint32_t positionLow, uint32_t positionHigh, uint32_t length) {
+  uint64_t position = ((uint64_t)positionHigh << 32) | positionLow;
+  blake3_hasher_finalize_seek(&xof_hasher, position, main_buffer, length);
+}
+
 WASM_EXPORT
 void Hash_Calculate(uint32_t length, uint32_t initParam, uint32_t digestBytes) {
   Hash_Init(initParam);
   Hash_Update(length);
   Hash_Final(digestBytes);
 }
+
+static void calculate_one(uint32_t length, uint32_t initParam,
+                          uint32_t finalParam) {
+  Hash_Calculate(length, initParam, finalParam);
+}
+
+WASM_EXPORT
+void Hash_CalculateMany(uint32_t count, uint32_t digestLength,
+                        uint32_t initParam, uint32_t finalParam) {
+  calculate_many(count, digestLength, initParam, finalParam, calculate_one);
+}
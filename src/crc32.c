@@ -14,6 +14,34 @@
 #define bswap_32(x) __builtin_bswap32(x)
 
 alignas(128) static uint32_t crc32_lookup[8][256] = {0};
+// x^(2^k) modulo the polynomial, the operators of Hash_Combine()
+static uint32_t x2n_table[64];
+
+// Multiplies a and b modulo the polynomial. The polynomials are
+// bit-reflected, the top bit is the coefficient of x^0.
+static uint32_t multmodp(uint32_t a, uint32_t b, uint32_t polynomial) {
+  uint32_t p = 0;
+  for (uint32_t m = (uint32_t)1 << 31; m != 0; m >>= 1) {
+    if (a & m) {
+      p ^= b;
+    }
+    b = (b >> 1) ^ (-(int32_t)(b & 1) & polynomial);
+  }
+  return p;
+}
+
+// Returns x^(n * 2^k) modulo the polynomial
+static uint32_t x2nmodp(uint64_t n, uint32_t k, uint32_t polynomial) {
+  uint32_t p = (uint32_t)1 << 31; // x^0
+  while (n) {
+    if (n & 1) {
+      p = multmodp(x2n_table[k], p, polynomial);
+    }
+    n >>= 1;
+    k++;
+  }
+  return p;
+}
 
 void init_lut(uint32_t polynomial) {
   for (int i = 0; i < 256; ++i) {
@@ -31,18 +59,28 @@ void init_lut(uint32_t polynomial) {
       crc32_lookup[j][i] = lv;
     }
   }
+
+  uint32_t p = (uint32_t)1 << 30; // x^1
+  x2n_table[0] = p;
+  for (int k = 1; k < 64; ++k) {
+    p = multmodp(p, p, polynomial);
+    x2n_table[k] = p;
+  }
 }
 
 uint32_t crc32_lut_initialized_to = 0;
 uint32_t previous_crc32 = 0;
 
-WASM_EXPORT
-void Hash_Init(uint32_t polynomial) {
+static void set_polynomial(uint32_t polynomial) {
   if (crc32_lut_initialized_to != polynomial) {
     init_lut(polynomial);
     crc32_lut_initialized_to = polynomial;
   }
+}
 
+WASM_EXPORT
+void Hash_Init(uint32_t polynomial) {
+  set_polynomial(polynomial);
   previous_crc32 = 0;
 }
 
@@ -86,9 +124,39 @@ const uint32_t STATE_SIZE = sizeof(previous_crc32);
 WASM_EXPORT
 uint8_t *Hash_GetState() { return (uint8_t *)&previous_crc32; }
 
+/**
+ * Combines the CRCs of two consecutive parts stored in main_buffer (in the
+ * byte order of Hash_Final()) into the CRC of the whole data, in the style
+ * of zlib's crc32_combine(). The length of the second part is split into
+ * two 32-bit halves. The result is written to the start of main_buffer.
+ */
+WASM_EXPORT
+void Hash_Combine(uint32_t polynomial, uint32_t lengthLow,
+                  uint32_t lengthHigh) {
+  set_polynomial(polynomial);
+  uint64_t length = ((uint64_t)lengthHigh << 32) | lengthLow;
+  uint32_t crc1 = bswap_32(((uint32_t *)main_buffer)[0]);
+  uint32_t crc2 = bswap_32(((uint32_t *)main_buffer)[1]);
+  // shifts crc1 by the bits of the second part: x^(8 * length)
+  uint32_t op = x2nmodp(length, 3, polynomial);
+  uint32_t crc = multmodp(op, crc1, polynomial) ^ crc2;
+  ((uint32_t *)main_buffer)[0] = bswap_32(crc);
+}
+
 WASM_EXPORT
 void Hash_Calculate(uint32_t length, uint32_t initParam) {
   Hash_Init(initParam);
   Hash_Update(length);
   Hash_Final();
 }
+
+static void calculate_one(uint32_t length, uint32_t initParam,
+                          uint32_t finalParam) {
+  Hash_Calculate(length, initParam);
+}
+
+WASM_EXPORT
+void Hash_CalculateMany(uint32_t count, uint32_t digestLength,
+                        uint32_t initParam, uint32_t finalParam) {
+  calculate_many(count, digestLength, initParam, finalParam, calculate_one);
+}
@@ -8,6 +8,34 @@
 #define bswap_64(x) __builtin_bswap64(x)
 
 alignas(128) static uint64_t crc64_lookup[8][256] = {0};
+// x^(2^k) modulo the polynomial, the operators of Hash_Combine()
+static uint64_t x2n_table[64];
+
+// Multiplies a and b modulo the polynomial. The polynomials are
+// bit-reflected, the top bit is the coefficient of x^0.
+static uint64_t multmodp(uint64_t a, uint64_t b, uint64_t polynomial) {
+  uint64_t p = 0;
+  for (uint64_t m = (uint64_t)1 << 63; m != 0; m >>= 1) {
+    if (a & m) {
+      p ^= b;
+    }
+    b = (b >> 1) ^ (-(int64_t)(b & 1) & polynomial);
+  }
+  return p;
+}
+
+// Returns x^(n * 2^k) modulo the polynomial
+static uint64_t x2nmodp(uint64_t n, uint32_t k, uint64_t polynomial) {
+  uint64_t p = (uint64_t)1 << 63; // x^0
+  while (n) {
+    if (n & 1) {
+      p = multmodp(x2n_table[k], p, polynomial);
+    }
+    n >>= 1;
+    k++;
+  }
+  return p;
+}
 
 void init_lut(uint64_t polynomial) {
   for (int i = 0; i < 256; ++i) {
@@ -25,21 +53,29 @@ void init_lut(uint64_t polynomial) {
       crc64_lookup[j][i] = lv;
     }
   }
+
+  uint64_t p = (uint64_t)1 << 62; // x^1
+  x2n_table[0] = p;
+  for (int k = 1; k < 64; ++k) {
+    p = multmodp(p, p, polynomial);
+    x2n_table[k] = p;
+  }
 }
 
 uint64_t crc64_lut_initialized_to = 0;
 uint64_t previous_crc64 = 0;
 
-WASM_EXPORT
-void Hash_Init() {
-  // polynomial is at the memory object
-  uint64_t polynomial = *((uint64_t *)main_buffer);
-
+static void set_polynomial(uint64_t polynomial) {
   if (crc64_lut_initialized_to != polynomial) {
     init_lut(polynomial);
     crc64_lut_initialized_to = polynomial;
   }
+}
 
+WASM_EXPORT
+void Hash_Init() {
+  // polynomial is at the memory object
+  set_polynomial(*((uint64_t *)main_buffer));
   previous_crc64 = 0;
 }
 
@@ -82,5 +118,25 @@ const uint32_t STATE_SIZE = sizeof(previous_crc64);
 WASM_EXPORT
 uint8_t *Hash_GetState() { return (uint8_t *)&previous_crc64; }
 
+/**
+ * Combines the CRCs of two consecutive parts into the CRC of the whole
+ * data, in the style of zlib's crc32_combine(). The memory object contains
+ * the polynomial, followed by the two CRCs in the byte order of
+ * Hash_Final(). The length of the second part is split into two 32-bit
+ * halves. The result is written to the start of main_buffer.
+ */
+WASM_EXPORT
+void Hash_Combine(uint32_t lengthLow, uint32_t lengthHigh) {
+  uint64_t polynomial = ((uint64_t *)main_buffer)[0];
+  set_polynomial(polynomial);
+  uint64_t length = ((uint64_t)lengthHigh << 32) | lengthLow;
+  uint64_t crc1 = bswap_64(((uint64_t *)main_buffer)[1]);
+  uint64_t crc2 = bswap_64(((uint64_t *)main_buffer)[2]);
+  // shifts crc1 by the bits of the second part: x^(8 * length)
+  uint64_t op = x2nmodp(length, 3, polynomial);
+  uint64_t crc = multmodp(op, crc1, polynomial) ^ crc2;
+  ((uint64_t *)main_buffer)[0] = bswap_64(crc);
+}
+
 WASM_EXPORT
 void Hash_Calculate() { return; }
@@ -22,6 +22,72 @@ uint8_t *Hash_GetBuffer() {
   return main_buffer;
 }
 
+#define DIGEST_FORMAT_HEX 0
+#define DIGEST_FORMAT_BASE64 1
+#define DIGEST_FORMAT_BASE64URL 2
+
+static const uint8_t hex_chars[16] = "0123456789abcdef";
+static const uint8_t base64_chars[64] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const uint8_t base64url_chars[64] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/**
+ * Encodes the digest stored at the start of main_buffer as text.
+ * The characters are written right after the digest (main_buffer + length).
+ * Base64 output is padded, base64url output is not.
+ *
+ * @param length digest length in bytes
+ * @param format one of the DIGEST_FORMAT_* values
+ * @return number of written characters
+ */
+WASM_EXPORT
+uint32_t Hash_EncodeDigest(uint32_t length, uint32_t format) {
+  const uint8_t *src = main_buffer;
+  uint8_t *dst = main_buffer + length;
+
+  if (format == DIGEST_FORMAT_HEX) {
+    for (uint32_t i = 0; i < length; i++) {
+      dst[i * 2] = hex_chars[src[i] >> 4];
+      dst[i * 2 + 1] = hex_chars[src[i] & 0xf];
+    }
+    return length * 2;
+  }
+
+  const uint8_t *chars =
+    format == DIGEST_FORMAT_BASE64URL ? base64url_chars : base64_chars;
+  uint8_t *p = dst;
+  uint32_t i = 0;
+
+  for (; i + 3 <= length; i += 3) {
+    uint32_t triplet = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+    *p++ = chars[(triplet >> 18) & 0x3f];
+    *p++ = chars[(triplet >> 12) & 0x3f];
+    *p++ = chars[(triplet >> 6) & 0x3f];
+    *p++ = chars[triplet & 0x3f];
+  }
+
+  uint32_t extra_bytes = length - i;
+  if (extra_bytes == 1) {
+    *p++ = chars[src[i] >> 2];
+    *p++ = chars[(src[i] << 4) & 0x3f];
+    if (format == DIGEST_FORMAT_BASE64) {
+      *p++ = '=';
+      *p++ = '=';
+    }
+  } else if (extra_bytes == 2) {
+    uint32_t pair = (src[i] << 8) | src[i + 1];
+    *p++ = chars[pair >> 10];
+    *p++ = chars[(pair >> 4) & 0x3f];
+    *p++ = chars[(pair << 2) & 0x3f];
+    if (format == DIGEST_FORMAT_BASE64) {
+      *p++ = '=';
+    }
+  }
+
+  return p - dst;
+}
+
 #endif
 
 // Sometimes LLVM emits these functions during the optimization step
@@ -130,3 +196,262 @@ static __inline__ void memset128(void* dst, const uint8_t value) {
     dst64[i] = val;
   }
 }
+
+#ifdef WITH_BUFFER
+
+/* Layout of main_buffer used by Hash_CalculateMany():
+ * [0, BATCH_MAX_MESSAGE_LENGTH): the current message is copied here
+ * [BATCH_LENGTHS_OFFSET, BATCH_DATA_OFFSET): uint32_t length of each message
+ * [BATCH_DATA_OFFSET, ...): the concatenated messages, followed by the digests
+ */
+#define BATCH_MAX_COUNT 256
+#define BATCH_MAX_MESSAGE_LENGTH 4096
+#define BATCH_LENGTHS_OFFSET BATCH_MAX_MESSAGE_LENGTH
+#define BATCH_DATA_OFFSET (BATCH_LENGTHS_OFFSET + BATCH_MAX_COUNT * 4)
+
+typedef void (*calculate_func)(uint32_t length, uint32_t initParam,
+                               uint32_t finalParam);
+
+static __inline__ void calculate_many(uint32_t count, uint32_t digest_length,
+                                      uint32_t init_param,
+                                      uint32_t final_param,
+                                      calculate_func calculate) {
+  const uint32_t *lengths = (uint32_t *)(main_buffer + BATCH_LENGTHS_OFFSET);
+  const uint8_t *message = main_buffer + BATCH_DATA_OFFSET;
+
+  uint8_t *output = main_buffer + BATCH_DATA_OFFSET;
+  for (uint32_t i = 0; i < count; i++) {
+    output += lengths[i];
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    memcpy(main_buffer, message, lengths[i]);
+    calculate(lengths[i], init_param, final_param);
+    memcpy(output, main_buffer, digest_length);
+    message += lengths[i];
+    output += digest_length;
+  }
+}
+
+/* HMAC built on the Hash_* functions of a module.
+ * The hash states after absorbing the inner and the outer padded keys are
+ * stored by hmac_init(), so every message only costs the compressions of
+ * the message itself and of the inner digest.
+ * Keys longer than the block size have to be hashed by the caller.
+ */
+#define HMAC_MAX_BLOCK_SIZE 144
+#define HMAC_MAX_STATE_SIZE 512
+
+typedef void (*hash_init_func)(uint32_t init_param);
+typedef void (*hash_update_func)(uint32_t length);
+typedef void (*hash_final_func)(uint32_t final_param);
+
+typedef struct {
+  hash_init_func init;
+  hash_update_func update;
+  hash_final_func final;
+} hmac_hash;
+
+static struct {
+  uint32_t digest_length;
+  uint32_t final_param;
+  uint32_t state_size;
+  alignas(8) uint8_t inner_state[HMAC_MAX_STATE_SIZE];
+  alignas(8) uint8_t outer_state[HMAC_MAX_STATE_SIZE];
+} hmac_ctx;
+
+static __inline__ void hmac_init(const hmac_hash *hash, uint8_t *state,
+                                 uint32_t state_size, uint32_t key_length,
+                                 uint32_t block_size, uint32_t digest_length,
+                                 uint32_t init_param, uint32_t final_param) {
+  uint8_t key[HMAC_MAX_BLOCK_SIZE];
+  memcpy(key, main_buffer, key_length);
+  memset(key + key_length, 0, block_size - key_length);
+
+  hmac_ctx.digest_length = digest_length;
+  hmac_ctx.final_param = final_param;
+  hmac_ctx.state_size = state_size;
+
+  for (uint32_t i = 0; i < block_size; i++) {
+    main_buffer[i] = key[i] ^ 0x5c;
+  }
+  hash->init(init_param);
+  hash->update(block_size);
+  memcpy(hmac_ctx.outer_state, state, state_size);
+
+  for (uint32_t i = 0; i < block_size; i++) {
+    main_buffer[i] = key[i] ^ 0x36;
+  }
+  hash->init(init_param);
+  hash->update(block_size);
+  memcpy(hmac_ctx.inner_state, state, state_size);
+}
+
+static __inline__ void hmac_reset(uint8_t *state) {
+  memcpy(state, hmac_ctx.inner_state, hmac_ctx.state_size);
+}
+
+static __inline__ void hmac_final(const hmac_hash *hash, uint8_t *state) {
+  hash->final(hmac_ctx.final_param);
+  memcpy(state, hmac_ctx.outer_state, hmac_ctx.state_size);
+  hash->update(hmac_ctx.digest_length);
+  hash->final(hmac_ctx.final_param);
+}
+
+static __inline__ void hmac_calculate(const hmac_hash *hash, uint8_t *state,
+                                      uint32_t length) {
+  hmac_reset(state);
+  hash->update(length);
+  hmac_final(hash, state);
+}
+
+/* Defines the Hmac_* exports of a module on top of its Hash_Update(),
+ * Hash_GetState() and STATE_SIZE. init_expr and final_expr start and finish
+ * the underlying hash, they can use initParam and finalParam.
+ * The hash functions are also available as `hmac` for pbkdf2_calculate().
+ */
+#define WITH_HMAC(init_expr, final_expr)                                      \
+  static void hmac_hash_init(uint32_t initParam) { init_expr; }               \
+                                                                              \
+  static void hmac_hash_final(uint32_t finalParam) { final_expr; }            \
+                                                                              \
+  static const hmac_hash hmac = {hmac_hash_init, Hash_Update,                 \
+                                 hmac_hash_final};                            \
+                                                                              \
+  WASM_EXPORT                                                                 \
+  void Hmac_Init(uint32_t keyLength, uint32_t blockSize,                      \
+                 uint32_t digestLength, uint32_t initParam,                   \
+                 uint32_t finalParam) {                                       \
+    hmac_init(&hmac, Hash_GetState(), STATE_SIZE, keyLength, blockSize,       \
+              digestLength, initParam, finalParam);                           \
+  }                                                                           \
+                                                                              \
+  WASM_EXPORT                                                                 \
+  void Hmac_Reset() { hmac_reset(Hash_GetState()); }                          \
+                                                                              \
+  WASM_EXPORT                                                                 \
+  void Hmac_Final() { hmac_final(&hmac, Hash_GetState()); }                   \
+                                                                              \
+  WASM_EXPORT                                                                 \
+  void Hmac_Calculate(uint32_t length) {                                      \
+    hmac_calculate(&hmac, Hash_GetState(), length);                           \
+  }                                                                           \
+                                                                              \
+  static void hmac_calculate_one(uint32_t length, uint32_t initParam,         \
+                                 uint32_t finalParam) {                       \
+    Hmac_Calculate(length);                                                   \
+  }                                                                           \
+                                                                              \
+  WASM_EXPORT                                                                 \
+  void Hmac_CalculateMany(uint32_t count, uint32_t digestLength) {            \
+    calculate_many(count, digestLength, 0, 0, hmac_calculate_one);            \
+  }
+
+/* PBKDF2 with the HMAC keyed by hmac_init().
+ * The salt is read from main_buffer + pbkdf2_salt_offset(), the blocks of
+ * the derived key are collected after it and then moved to the start of
+ * main_buffer. U is kept at the start of main_buffer, where hmac_final()
+ * leaves the digest, so each iteration is a single hmac_calculate() call.
+ */
+#define PBKDF2_SALT_OFFSET 256
+#define PBKDF2_MAX_DIGEST_SIZE 64
+
+/* Long salts are placed after salt || INT(i), which is built at the start
+ * of main_buffer for each block.
+ */
+static __inline__ uint32_t pbkdf2_salt_offset(uint32_t salt_length) {
+  return salt_length + 4 > PBKDF2_SALT_OFFSET ? salt_length + 4
+                                              : PBKDF2_SALT_OFFSET;
+}
+
+static __inline__ void pbkdf2_calculate(const hmac_hash *hash, uint8_t *state,
+                                        uint32_t salt_length,
+                                        uint32_t iterations,
+                                        uint32_t dk_length) {
+  const uint32_t h_len = hmac_ctx.digest_length;
+  const uint32_t salt_offset = pbkdf2_salt_offset(salt_length);
+  const uint8_t *salt = main_buffer + salt_offset;
+  uint8_t *output = main_buffer + salt_offset + salt_length;
+  alignas(8) uint8_t t[PBKDF2_MAX_DIGEST_SIZE];
+
+  uint32_t block = 1;
+  for (uint32_t pos = 0; pos < dk_length; pos += h_len) {
+    memcpy(main_buffer, salt, salt_length);
+    main_buffer[salt_length] = block >> 24;
+    main_buffer[salt_length + 1] = block >> 16;
+    main_buffer[salt_length + 2] = block >> 8;
+    main_buffer[salt_length + 3] = block;
+    block++;
+
+    hmac_calculate(hash, state, salt_length + 4);
+    memcpy(t, main_buffer, h_len);
+
+    for (uint32_t i = 1; i < iterations; i++) {
+      hmac_calculate(hash, state, h_len);
+      for (uint32_t k = 0; k < h_len; k++) {
+        t[k] ^= main_buffer[k];
+      }
+    }
+
+    memcpy(output + pos, t, h_len);
+  }
+
+  memcpy(main_buffer, output, dk_length);
+}
+
+#endif
+
+#ifdef WITH_CONTEXTS
+
+/* Slab of additional hashing contexts for Hash_CreateContext().
+ * The slots are placed after the initial memory, which is grown on demand.
+ * Id 0 is the static context of the module, id N is the Nth slot.
+ * Released slots are kept in a free list, linked through their first
+ * 4 bytes.
+ */
+#define CONTEXT_PAGE_SIZE 65536
+
+static uint8_t *context_slab = NULL;
+static uint32_t context_count = 0;
+static uint32_t context_free_list = 0;
+
+static __inline__ uint32_t context_slot_size(uint32_t state_size) {
+  return (state_size + 7) & ~7;
+}
+
+static __inline__ uint8_t *context_get(uint32_t id, uint32_t state_size) {
+  return context_slab + (id - 1) * context_slot_size(state_size);
+}
+
+// returns 0 if the memory cannot be grown
+static uint32_t context_alloc(uint32_t state_size) {
+  if (context_free_list != 0) {
+    uint32_t id = context_free_list;
+    context_free_list = *(uint32_t *)context_get(id, state_size);
+    return id;
+  }
+
+  uint8_t *memory_end =
+    (uint8_t *)(__builtin_wasm_memory_size(0) * CONTEXT_PAGE_SIZE);
+  if (context_slab == NULL) {
+    context_slab = memory_end;
+  }
+
+  uint8_t *slot_end = context_get(context_count + 2, state_size);
+  if (slot_end > memory_end) {
+    uint32_t pages =
+      (slot_end - memory_end + CONTEXT_PAGE_SIZE - 1) / CONTEXT_PAGE_SIZE;
+    if (__builtin_wasm_memory_grow(0, pages) == -1) {
+      return 0;
+    }
+  }
+
+  return ++context_count;
+}
+
+static __inline__ void context_release(uint32_t id, uint32_t state_size) {
+  *(uint32_t *)context_get(id, state_size) = context_free_list;
+  context_free_list = id;
+}
+
+#endif
@@ -28,6 +28,7 @@
  */
 
 #define WITH_BUFFER
+#define WITH_CONTEXTS
 #include "hash-wasm.h"
 
 #define RIPEMD160_BLOCK_LENGTH 64
@@ -300,9 +301,38 @@ uint8_t* Hash_GetState() {
   return (uint8_t*) ctx;
 }
 
+WASM_EXPORT
+uint32_t Hash_CreateContext() {
+  return context_alloc(sizeof(*ctx));
+}
+
+WASM_EXPORT
+void Hash_SelectContext(uint32_t id) {
+  ctx = id == 0 ? &sctx : (struct RIPEMD160_CTX*) context_get(id, sizeof(*ctx));
+}
+
+WASM_EXPORT
+void Hash_DestroyContext(uint32_t id) {
+  if ((uint8_t*) ctx == context_get(id, sizeof(*ctx))) {
+    ctx = &sctx;
+  }
+  context_release(id, sizeof(*ctx));
+}
+
 WASM_EXPORT
 void Hash_Calculate(uint32_t length) {
   Hash_Init();
   Hash_Update(length);
   Hash_Final();
 }
+
+static void calculate_one(uint32_t length, uint32_t initParam,
+                          uint32_t finalParam) {
+  Hash_Calculate(length);
+}
+
+WASM_EXPORT
+void Hash_CalculateMany(uint32_t count, uint32_t digestLength,
+                        uint32_t initParam, uint32_t finalParam) {
+  calculate_many(count, digestLength, initParam, finalParam, calculate_one);
+}
@@ -37,11 +37,11 @@ uint8_t *B = NULL;
 uint64_t B_size = 0;
 
 WASM_EXPORT
-int8_t Hash_SetMemorySize(uint32_t total_bytes) {
-  uint32_t bytes_required = total_bytes - B_size;
-
-  if (bytes_required > 0) {
-    uint32_t blocks = bytes_required / BYTES_PER_PAGE;
+int8_t Hash_SetMemorySize(uintptr_t total_bytes) {
+  // the memory cannot shrink, reused instances keep the grown memory
+  if (total_bytes > B_size) {
+    uintptr_t bytes_required = total_bytes - B_size;
+    uintptr_t blocks = bytes_required / BYTES_PER_PAGE;
     if (blocks * BYTES_PER_PAGE < bytes_required) {
       blocks += 1;
     }
@@ -70,6 +70,206 @@ uint8_t *Hash_GetBuffer() {
   return B;
 }
 
+/* SHA-256, HMAC-SHA256 and single iteration PBKDF2-HMAC-SHA256 */
+
+typedef struct {
+  uint32_t h[8];
+  uint64_t length;
+  uint8_t buf[64];
+  uint32_t buflen;
+} sha256_ctx;
+
+typedef struct {
+  sha256_ctx inner;
+  sha256_ctx outer;
+} hmac_sha256_ctx;
+
+static const uint32_t sha256_K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr32(uint32_t x, uint32_t n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t be32dec(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void be32enc(uint8_t *p, uint32_t x) {
+  p[0] = x >> 24;
+  p[1] = x >> 16;
+  p[2] = x >> 8;
+  p[3] = x;
+}
+
+static void sha256_compress(uint32_t h[8], const uint8_t *block) {
+  uint32_t w[64];
+  for (uint32_t i = 0; i < 16; i++) {
+    w[i] = be32dec(block + i * 4);
+  }
+  for (uint32_t i = 16; i < 64; i++) {
+    uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+  uint32_t e = h[4], f = h[5], g = h[6], hh = h[7];
+
+  for (uint32_t i = 0; i < 64; i++) {
+    uint32_t S1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = hh + S1 + ch + sha256_K[i] + w[i];
+    uint32_t S0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t t2 = S0 + maj;
+    hh = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  h[0] += a;
+  h[1] += b;
+  h[2] += c;
+  h[3] += d;
+  h[4] += e;
+  h[5] += f;
+  h[6] += g;
+  h[7] += hh;
+}
+
+static void sha256_init(sha256_ctx *ctx) {
+  ctx->h[0] = 0x6a09e667;
+  ctx->h[1] = 0xbb67ae85;
+  ctx->h[2] = 0x3c6ef372;
+  ctx->h[3] = 0xa54ff53a;
+  ctx->h[4] = 0x510e527f;
+  ctx->h[5] = 0x9b05688c;
+  ctx->h[6] = 0x1f83d9ab;
+  ctx->h[7] = 0x5be0cd19;
+  ctx->length = 0;
+  ctx->buflen = 0;
+}
+
+static void sha256_update(sha256_ctx *ctx, const uint8_t *in, uintptr_t len) {
+  ctx->length += len;
+
+  while (len > 0) {
+    // full blocks are compressed without copying
+    if (ctx->buflen == 0 && len >= 64) {
+      sha256_compress(ctx->h, in);
+      in += 64;
+      len -= 64;
+      continue;
+    }
+
+    ctx->buf[ctx->buflen++] = *in++;
+    len--;
+    if (ctx->buflen == 64) {
+      sha256_compress(ctx->h, ctx->buf);
+      ctx->buflen = 0;
+    }
+  }
+}
+
+static void sha256_final(sha256_ctx *ctx, uint8_t out[32]) {
+  uint64_t bits = ctx->length * 8;
+
+  ctx->buf[ctx->buflen++] = 0x80;
+  if (ctx->buflen > 56) {
+    memset(ctx->buf + ctx->buflen, 0, 64 - ctx->buflen);
+    sha256_compress(ctx->h, ctx->buf);
+    ctx->buflen = 0;
+  }
+  memset(ctx->buf + ctx->buflen, 0, 56 - ctx->buflen);
+  be32enc(ctx->buf + 56, bits >> 32);
+  be32enc(ctx->buf + 60, bits);
+  sha256_compress(ctx->h, ctx->buf);
+
+  for (uint32_t i = 0; i < 8; i++) {
+    be32enc(out + i * 4, ctx->h[i]);
+  }
+}
+
+static void hmac_sha256_init(hmac_sha256_ctx *ctx, const uint8_t *key,
+                             uint32_t keylen) {
+  uint8_t pad[64];
+  uint8_t key_hash[32];
+
+  if (keylen > 64) {
+    sha256_init(&ctx->inner);
+    sha256_update(&ctx->inner, key, keylen);
+    sha256_final(&ctx->inner, key_hash);
+    key = key_hash;
+    keylen = 32;
+  }
+
+  for (uint32_t i = 0; i < 64; i++) {
+    pad[i] = (i < keylen ? key[i] : 0) ^ 0x36;
+  }
+  sha256_init(&ctx->inner);
+  sha256_update(&ctx->inner, pad, 64);
+
+  for (uint32_t i = 0; i < 64; i++) {
+    pad[i] ^= 0x36 ^ 0x5c;
+  }
+  sha256_init(&ctx->outer);
+  sha256_update(&ctx->outer, pad, 64);
+}
+
+static void hmac_sha256_final(hmac_sha256_ctx *ctx, uint8_t out[32]) {
+  uint8_t inner_hash[32];
+  sha256_final(&ctx->inner, inner_hash);
+  sha256_update(&ctx->outer, inner_hash, 32);
+  sha256_final(&ctx->outer, out);
+}
+
+/**
+ * pbkdf2_sha256(password, passwordLen, salt, saltLen, out, outLen):
+ * PBKDF2-HMAC-SHA256 with a single iteration, as used by scrypt.
+ * The salt is absorbed only once, the state after it is reused for
+ * every output block.
+ */
+static void pbkdf2_sha256(const uint8_t *password, uint32_t passwordLen,
+                          const uint8_t *salt, uintptr_t saltLen,
+                          uint8_t *out, uintptr_t outLen) {
+  hmac_sha256_ctx salted;
+  hmac_sha256_ctx ctx;
+  uint8_t index[4];
+  uint8_t T[32];
+
+  hmac_sha256_init(&salted, password, passwordLen);
+  sha256_update(&salted.inner, salt, saltLen);
+
+  uint32_t block = 1;
+  for (uintptr_t pos = 0; pos < outLen; pos += 32) {
+    memcpy(&ctx, &salted, sizeof(ctx));
+    be32enc(index, block++);
+    sha256_update(&ctx.inner, index, 4);
+    hmac_sha256_final(&ctx, T);
+
+    uint32_t len = outLen - pos < 32 ? outLen - pos : 32;
+    memcpy(out + pos, T, len);
+  }
+}
+
 static inline uint32_t le32dec(const void *pp) {
   return ((uint32_t *)pp)[0];
 }
@@ -222,7 +422,7 @@ void smix(uint8_t *B, int r, uint64_t N, void *_V, void *XY) {
     /* 3: V_i <-- X */
 
     for (uint32_t j = 0; j < r; j++) {
-      uint64_t *dest = &(((uint64_t *)&V[i * (32 * r)])[j * 16]);
+      uint64_t *dest = &(((uint64_t *)&V[(uintptr_t)i * (32 * r)])[j * 16]);
       uint64_t *src = &(((uint64_t *)X)[j * 16]);
       #pragma clang loop unroll(full)
       for (uint8_t jj = 0; jj < 16; jj++) {
@@ -234,7 +434,7 @@ void smix(uint8_t *B, int r, uint64_t N, void *_V, void *XY) {
 
     /* 3: V_i <-- X */
     for (uint32_t j = 0; j < r; j++) {
-      uint64_t *dest = &(((uint64_t *)&V[(i + 1) * (32 * r)])[j * 16]);
+      uint64_t *dest = &(((uint64_t *)&V[(uintptr_t)(i + 1) * (32 * r)])[j * 16]);
       uint64_t *src = &(((uint64_t *)Y)[j * 16]);
       #pragma clang loop unroll(full)
       for (uint8_t jj = 0; jj < 16; jj++) {
@@ -254,7 +454,7 @@ void smix(uint8_t *B, int r, uint64_t N, void *_V, void *XY) {
     /* 8: X <-- H(X \xor V_j) */
     for (uint32_t z = 0; z < r; z++) {
       uint64_t *dest = &(((uint64_t *)X)[z * 16]);
-      uint64_t *src = &(((uint64_t *)&V[j * (32 * r)])[z * 16]);
+      uint64_t *src = &(((uint64_t *)&V[(uintptr_t)j * (32 * r)])[z * 16]);
       #pragma clang loop unroll(full)
       for (uint8_t zz = 0; zz < 16; zz++) {
         dest[zz] ^= src[zz];
@@ -268,7 +468,7 @@ void smix(uint8_t *B, int r, uint64_t N, void *_V, void *XY) {
     /* 8: X <-- H(X \xor V_j) */
     for (uint32_t z = 0; z < r; z++) {
       uint64_t *dest = &(((uint64_t *)Y)[z * 16]);
-      uint64_t *src = &(((uint64_t *)&V[j * (32 * r)])[z * 16]);
+      uint64_t *src = &(((uint64_t *)&V[(uintptr_t)j * (32 * r)])[z * 16]);
       #pragma clang loop unroll(full)
       for (uint8_t zz = 0; zz < 16; zz++) {
         dest[zz] ^= src[zz];
@@ -285,10 +485,30 @@ void smix(uint8_t *B, int r, uint64_t N, void *_V, void *XY) {
 
 WASM_EXPORT
 void scrypt(uint32_t blockSize, uint32_t costFactor, uint32_t parallelism) {
-  uint8_t *V = &B[128 * blockSize * parallelism];
-  uint8_t *XY = &V[128 * blockSize * costFactor];
+  // the blocks and V can be larger than 4 GiB in the wasm64 build
+  uint8_t *V = &B[(uintptr_t)128 * blockSize * parallelism];
+  uint8_t *XY = &V[(uintptr_t)128 * blockSize * costFactor];
 
   for (uint32_t i = 0; i < parallelism; i++) {
-    smix(&B[i * 128 * blockSize], blockSize, costFactor, V, XY);
+    smix(&B[(uintptr_t)i * 128 * blockSize], blockSize, costFactor, V, XY);
   }
 }
+
+/**
+ * Calculates the whole scrypt hash. The password and the salt are read from
+ * the memory after the blocks, V and XY. The derived key is written after
+ * the salt.
+ */
+WASM_EXPORT
+void scrypt_full(uint32_t passwordLen, uint32_t saltLen, uint32_t costFactor,
+                 uint32_t blockSize, uint32_t parallelism, uint32_t dkLen) {
+  uintptr_t blocksLength = (uintptr_t)128 * blockSize * parallelism;
+  uint8_t *password = &B[blocksLength + (uintptr_t)128 * blockSize * costFactor +
+                         256 * blockSize + 64];
+  uint8_t *salt = password + passwordLen;
+  uint8_t *output = salt + saltLen;
+
+  pbkdf2_sha256(password, passwordLen, salt, saltLen, B, blocksLength);
+  scrypt(blockSize, costFactor, parallelism);
+  pbkdf2_sha256(password, passwordLen, B, blocksLength, output, dkLen);
+}
@@ -7,6 +7,7 @@ Modified for hash-wasm by Dani Biró
 */
 
 #define WITH_BUFFER
+#define WITH_CONTEXTS
 #include "hash-wasm.h"
 
 #define rol(value, bits) (((value) << (bits)) | ((value) >> (32 - (bits))))
@@ -184,9 +185,46 @@ uint8_t* Hash_GetState() {
   return (uint8_t*) context;
 }
 
+WASM_EXPORT
+uint32_t Hash_CreateContext() {
+  return context_alloc(sizeof(*context));
+}
+
+WASM_EXPORT
+void Hash_SelectContext(uint32_t id) {
+  context = id == 0 ? &sctx : (struct SHA1_CTX*) context_get(id, sizeof(*context));
+}
+
+WASM_EXPORT
+void Hash_DestroyContext(uint32_t id) {
+  if ((uint8_t*) context == context_get(id, sizeof(*context))) {
+    context = &sctx;
+  }
+  context_release(id, sizeof(*context));
+}
+
 WASM_EXPORT
 void Hash_Calculate(uint32_t length) {
   Hash_Init();
   Hash_Update(length);
   Hash_Final();
 }
+
+static void calculate_one(uint32_t length, uint32_t initParam,
+                          uint32_t finalParam) {
+  Hash_Calculate(length);
+}
+
+WASM_EXPORT
+void Hash_CalculateMany(uint32_t count, uint32_t digestLength,
+                        uint32_t initParam, uint32_t finalParam) {
+  calculate_many(count, digestLength, initParam, finalParam, calculate_one);
+}
+
+WITH_HMAC(Hash_Init(), Hash_Final())
+
+WASM_EXPORT
+void Pbkdf2_Calculate(uint32_t saltLength, uint32_t iterations,
+                      uint32_t dkLength) {
+  pbkdf2_calculate(&hmac, Hash_GetState(), saltLength, iterations, dkLength);
+}
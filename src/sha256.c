@@ -18,6 +18,7 @@
  */
 
 #define WITH_BUFFER
+#define WITH_CONTEXTS
 #include "hash-wasm.h"
 
 #define sha256_block_size 64
@@ -287,9 +288,46 @@ uint8_t* Hash_GetState() {
   return (uint8_t*) ctx;
 }
 
+WASM_EXPORT
+uint32_t Hash_CreateContext() {
+  return context_alloc(sizeof(*ctx));
+}
+
+WASM_EXPORT
+void Hash_SelectContext(uint32_t id) {
+  ctx = id == 0 ? &sctx : (struct sha256_ctx*) context_get(id, sizeof(*ctx));
+}
+
+WASM_EXPORT
+void Hash_DestroyContext(uint32_t id) {
+  if ((uint8_t*) ctx == context_get(id, sizeof(*ctx))) {
+    ctx = &sctx;
+  }
+  context_release(id, sizeof(*ctx));
+}
+
 WASM_EXPORT
 void Hash_Calculate(uint32_t length, uint32_t initParam) {
   Hash_Init(initParam);
   Hash_Update(length);
   Hash_Final();
 }
+
+static void calculate_one(uint32_t length, uint32_t initParam,
+                          uint32_t finalParam) {
+  Hash_Calculate(length, initParam);
+}
+
+WASM_EXPORT
+void Hash_CalculateMany(uint32_t count, uint32_t digestLength,
+                        uint32_t initParam, uint32_t finalParam) {
+  calculate_many(count, digestLength, initParam, finalParam, calculate_one);
+}
+
+WITH_HMAC(Hash_Init(initParam), Hash_Final())
+
+WASM_EXPORT
+void Pbkdf2_Calculate(uint32_t saltLength, uint32_t iterations,
+                      uint32_t dkLength) {
+  pbkdf2_calculate(&hmac, Hash_GetState(), saltLength, iterations, dkLength);
+}
@@ -1,5 +1,5 @@
 import fs from "node:fs";
-import { adler32, createAdler32 } from "../lib";
+import { adler32, adler32Combine, createAdler32 } from "../lib";
 import { getVariableLengthChunks } from "./util";
 /* global test, expect */
 
@@ -119,3 +119,25 @@ test("Invalid inputs throw", async () => {
 		expect(() => hash.update(input as any)).toThrow();
 	}
 });
+
+test("combine", async () => {
+	const data = "The quick brown fox jumps over the lazy dog. ".repeat(500);
+	for (const split of [0, 1, 7, 8, 9, 100, 10000, data.length]) {
+		const first = await adler32(data.slice(0, split));
+		const second = await adler32(data.slice(split));
+		expect(await adler32Combine(first, second, data.length - split)).toBe(
+			await adler32(data),
+		);
+	}
+
+	// compared to zlib's adler32_combine64()
+	expect(await adler32Combine("12345678", "0abcdef0", 2 ** 32 + 5)).toBe(
+		"d05d3576",
+	);
+	expect(await adler32Combine("12345678", "0abcdef0", 2 ** 53 - 1)).toBe(
+		"7b643576",
+	);
+
+	await expect(adler32Combine("1234567", "0abcdef0", 1)).rejects.toThrow();
+	await expect(adler32Combine("12345678", "0abcdef0", -1)).rejects.toThrow();
+});
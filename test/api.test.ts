@@ -2,9 +2,21 @@
 import * as api from "../lib";
 import type { IHasher } from "../lib/WASMInterface";
 
+// factories which need extra arguments or do not return an IHasher
+const NON_HASHER_FACTORIES = [
+	"createArgon2Engine",
+	"createHMAC",
+	"createHMACSync",
+	"createHashSink",
+	"createScryptEngine",
+];
+
 async function createAllFunctions(includeHMAC): Promise<IHasher[]> {
 	const keys = Object.keys(api).filter(
-		(key) => key.startsWith("create") && (includeHMAC || key !== "createHMAC"),
+		(key) =>
+			key.startsWith("create") &&
+			((includeHMAC && key === "createHMAC") ||
+				!NON_HASHER_FACTORIES.includes(key)),
 	);
 
 	return Promise.all(
@@ -21,7 +33,7 @@ async function createAllFunctions(includeHMAC): Promise<IHasher[]> {
 
 test("IHasherApi", async () => {
 	const functions: IHasher[] = await createAllFunctions(true);
-	expect(functions.length).toBe(23);
+	expect(functions.length).toBe(45);
 
 	for (const fn of functions) {
 		expect(fn.blockSize).toBeGreaterThan(0);
@@ -59,6 +71,78 @@ test("IHasherApi", async () => {
 	}
 });
 
+test("digest output types", async () => {
+	const functions: IHasher[] = await createAllFunctions(true);
+
+	for (const fn of functions) {
+		for (const data of ["", "a", "abc", "x".repeat(2000)]) {
+			fn.init();
+			fn.update(data);
+			const binary = fn.digest("binary");
+			const buf = Buffer.from(binary);
+
+			fn.init();
+			fn.update(data);
+			expect(fn.digest("base64")).toBe(buf.toString("base64"));
+			fn.init();
+			fn.update(data);
+			expect(fn.digest("base64url")).toBe(buf.toString("base64url"));
+
+			fn.init();
+			fn.update(data);
+			const target = new Uint8Array(fn.digestSize + 5).fill(0xaa);
+			expect(fn.digestInto(target, 3)).toBe(fn.digestSize);
+			expect(target.subarray(3, 3 + fn.digestSize)).toStrictEqual(binary);
+			expect(target.subarray(0, 3)).toStrictEqual(new Uint8Array(3).fill(0xaa));
+			expect(target.subarray(3 + fn.digestSize)).toStrictEqual(
+				new Uint8Array(2).fill(0xaa),
+			);
+			expect(() => fn.digestInto(target)).toThrow();
+		}
+
+		fn.init();
+		expect(() => fn.digestInto(new Uint8Array(fn.digestSize - 1))).toThrow();
+		expect(() => fn.digestInto(new Uint8Array(fn.digestSize), 1)).toThrow();
+		expect(() => fn.digestInto([] as any)).toThrow();
+		expect(fn.digestInto(new Uint8Array(fn.digestSize))).toBe(fn.digestSize);
+	}
+});
+
+test("hashMany", async () => {
+	const functions: IHasher[] = await createAllFunctions(true);
+	const messages: (string | Uint8Array)[] = [];
+	for (let i = 0; i < 600; i++) {
+		messages.push(i % 2 ? "a".repeat(i) : new Uint8Array(i).fill(i));
+	}
+	messages.push("😊".repeat(3000), new Uint8Array(20000), "", "x");
+
+	for (const fn of functions) {
+		const expected = messages.map((message) => {
+			fn.init();
+			fn.update(message);
+			return fn.digest("binary");
+		});
+
+		const binary = fn.hashMany(messages, "binary");
+		expect(binary.length).toBe(messages.length * fn.digestSize);
+		expected.forEach((digest, i) => {
+			expect(
+				binary.subarray(i * fn.digestSize, (i + 1) * fn.digestSize),
+			).toStrictEqual(digest);
+		});
+
+		const hex = fn.hashMany(messages);
+		expect(hex).toStrictEqual(
+			expected.map((digest) => Buffer.from(digest).toString("hex")),
+		);
+
+		expect(fn.hashMany([])).toStrictEqual([]);
+		expect(() => fn.update("a")).toThrow();
+		expect(() => fn.hashMany("a" as any)).toThrow();
+		expect(() => fn.hashMany([1] as any)).toThrow();
+	}
+});
+
 test("saveAndLoad", async () => {
 	const aHash: string[] = (await createAllFunctions(false)).map((fn) => {
 		fn.init();
@@ -73,7 +157,7 @@ test("saveAndLoad", async () => {
 
 	const functions: IHasher[] = await createAllFunctions(false);
 
-	expect(functions.length).toBe(22);
+	expect(functions.length).toBe(44);
 
 	functions.forEach((fn, index) => {
 		fn.init();
@@ -100,7 +184,7 @@ test("saveAndLoad - load as init", async () => {
 		fn.update("Hello world");
 		return fn.digest();
 	});
-	expect(helloWorldHashes.length).toBe(22);
+	expect(helloWorldHashes.length).toBe(44);
 	const savedHasherStates = (await createAllFunctions(false)).map((fn) => {
 		fn.update("Hello ");
 		return fn.save();
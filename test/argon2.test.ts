@@ -1,4 +1,11 @@
-import { argon2Verify, argon2d, argon2i, argon2id } from "../lib";
+import {
+	argon2Verify,
+	argon2d,
+	argon2i,
+	argon2id,
+	createArgon2Engine,
+} from "../lib";
+import { isMemory64Supported } from "./util";
 /* global test, expect */
 
 const hash = async (
@@ -251,6 +258,33 @@ test("others", async () => {
 	]);
 });
 
+test("hash lengths", async () => {
+	const expected = [
+		[4, "6b7a947d", "6b7a947d"],
+		[63, "9aac72737647dcb5", "1d22d3b1c661502b"],
+		[64, "1437f91898f231ac", "92f6b8416a5efd6c"],
+		[65, "8312a1bdee14a6d3", "546bb4d324361ddd"],
+		[129, "2c73f7ae220f703a", "786df762ff2fafe1"],
+		[1000, "7b1e23f44ba03f90", "8e4fc9bf24e3f05f"],
+		// longer than the memory blocks
+		[10000, "08e66bdc85714c95", "474be358117b416e"],
+	] as const;
+
+	for (const [hashLength, start, end] of expected) {
+		const result = await argon2id({
+			password: "password",
+			salt: "somesalt",
+			iterations: 1,
+			parallelism: 1,
+			memorySize: 8,
+			hashLength,
+		});
+		expect(result.length).toBe(hashLength * 2);
+		expect(result.startsWith(start)).toBe(true);
+		expect(result.endsWith(end)).toBe(true);
+	}
+});
+
 test("binary input", async () => {
 	expect(
 		await hashMultiple(
@@ -677,3 +711,91 @@ test("Invalid verify parameters", async () => {
 		"$argon2i$v=19$m=139,t=7,p=5$c29tZXNhbHQxMjM$7w2btZkTO1qudwcoh/Dd%",
 	);
 });
+
+test("engine reuses the instance", async () => {
+	// the input of H0 is stored after the blocks
+	const engine = await createArgon2Engine({ maxMemory: 1025 * 1024 });
+	const options = {
+		password: "a",
+		salt: "abcdefgh",
+		parallelism: 1,
+		iterations: 2,
+		hashLength: 16,
+	};
+
+	const instantiate = jest.spyOn(WebAssembly, "instantiate");
+	// larger and smaller memory sizes alternate on the same memory
+	for (const memorySize of [16, 1024, 16, 512]) {
+		for (const fn of ["argon2i", "argon2d", "argon2id"] as const) {
+			const expected = await { argon2i, argon2d, argon2id }[fn]({
+				...options,
+				memorySize,
+			});
+			instantiate.mockClear();
+			expect(await engine[fn]({ ...options, memorySize })).toBe(expected);
+			expect(instantiate).not.toHaveBeenCalled();
+		}
+	}
+	instantiate.mockRestore();
+
+	const encoded = await engine.argon2id({
+		...options,
+		memorySize: 64,
+		outputType: "encoded",
+	});
+	expect(await engine.argon2Verify({ password: "a", hash: encoded })).toBe(
+		true,
+	);
+	expect(await engine.argon2Verify({ password: "b", hash: encoded })).toBe(
+		false,
+	);
+
+	await expect(
+		engine.argon2i({ ...options, memorySize: 2048 }),
+	).rejects.toThrow();
+	await expect(
+		engine.argon2i({
+			...options,
+			memorySize: 1024,
+			password: "a".repeat(1024),
+		}),
+	).rejects.toThrow();
+	await expect(engine.argon2i({ ...options, iterations: 0 })).rejects.toThrow();
+
+	engine.dispose();
+	await expect(
+		engine.argon2i({ ...options, memorySize: 16 }),
+	).rejects.toThrow();
+	await expect(createArgon2Engine({ maxMemory: -1 })).rejects.toThrow();
+});
+
+test("memory64 build", async () => {
+	const options = {
+		password: "a",
+		salt: "abcdefgh",
+		parallelism: 2,
+		iterations: 2,
+		memorySize: 256,
+		hashLength: 32,
+	};
+
+	if (!isMemory64Supported()) {
+		await expect(
+			argon2id({ ...options, memorySize: 4 * 1024 ** 2 }),
+		).rejects.toThrow("does not support memory64");
+		return;
+	}
+
+	// the engine uses the memory64 build if maxMemory is over 2 GiB
+	const engine = await createArgon2Engine({ maxMemory: 4 * 1024 ** 3 });
+	expect(await engine.argon2id(options)).toBe(await argon2id(options));
+	engine.dispose();
+
+	// 32 GiB is over the limit of the memory64 build
+	await expect(
+		argon2id({ ...options, memorySize: 32 * 1024 ** 2 }),
+	).rejects.toThrow();
+	await expect(
+		createArgon2Engine({ maxMemory: 32 * 1024 ** 3 }),
+	).rejects.toThrow();
+});
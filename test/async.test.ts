@@ -1,6 +1,9 @@
 /* global test, expect */
+import crypto from "node:crypto";
 import {
 	blake2b,
+	blake3,
+	createBLAKE3,
 	keccak,
 	md4,
 	md5,
@@ -65,3 +68,53 @@ test("Async cycle multiple algorithms", async () => {
 
 	console.log("After", getMemoryUsage());
 });
+
+test("Concurrent first calls with different variants", async () => {
+	const promises = [];
+	for (let i = 0; i < 20; i++) {
+		promises.push(sha3("a", 224), sha3("a", 512), keccak("a", 224));
+	}
+
+	const res = await Promise.all(promises);
+	for (let i = 0; i < res.length; i += 3) {
+		expect(res[i]).toBe(
+			"9e86ff69557ca95f405f081269685b38e3a819b309ee942f482b6a8b",
+		);
+		expect(res[i + 1]).toBe(
+			"697f2d856172cb8309d6b8b97dac4de344b549d4dee61edfb4962d8698b7fa803f4f93ff24393586e28b5b957ac3d1d369420ce53332712f997bd336d09ab02a",
+		);
+		expect(res[i + 2]).toBe(
+			"7cf87d912ee7088d30ec23f8e7100d9319bff090618b439d3fe91308",
+		);
+	}
+});
+
+test("Alternating variants reuse the cached instance", async () => {
+	const nodeHash = (algorithm: string) =>
+		crypto.createHash(algorithm).update("abc").digest("hex");
+	const blake3Hash = async (bits: number) => {
+		const hasher = await createBLAKE3(bits);
+		hasher.update("abc");
+		return hasher.digest();
+	};
+
+	const expected = {
+		sha3: [nodeHash("sha3-256"), nodeHash("sha3-512")],
+		blake2b: nodeHash("blake2b512"),
+		blake3: [await blake3Hash(256), await blake3Hash(512)],
+	};
+	// the first calls create the cached instances
+	await Promise.all([sha3("abc", 256), blake2b("abc", 256), blake3("abc")]);
+
+	const instantiate = jest.spyOn(WebAssembly, "instantiate");
+	for (let i = 0; i < 10; i++) {
+		expect(await sha3("abc", 256)).toBe(expected.sha3[0]);
+		expect(await sha3("abc", 512)).toBe(expected.sha3[1]);
+		expect(await blake2b("abc", 512)).toBe(expected.blake2b);
+		expect(await blake3("abc", 256)).toBe(expected.blake3[0]);
+		expect(await blake3("abc", 512)).toBe(expected.blake3[1]);
+	}
+	expect(await blake2b("abc", 256)).toHaveLength(64);
+	expect(instantiate).not.toHaveBeenCalled();
+	instantiate.mockRestore();
+});
@@ -84,6 +84,22 @@ test("unicode string length handling", async () => {
 	}
 });
 
+test("unicode strings spanning chunk boundaries", async () => {
+	const md4Instance = await createMD4();
+	const inputs = [
+		`a${"😊".repeat(MAX_HEAP)}`,
+		`ab${"ѱ彁𠜎".repeat(MAX_HEAP / 4)}`,
+		`${"\ud83d".repeat(MAX_HEAP / 2)}x\ude0a${"a\ud83d".repeat(MAX_HEAP)}`,
+	];
+
+	for (const str of inputs) {
+		const ok = await md4(Buffer.from(str));
+		md4Instance.init();
+		md4Instance.update(str);
+		expect(md4Instance.digest()).toBe(ok);
+	}
+});
+
 test("hexStringEqualsUInt8()", async () => {
 	expect(hexStringEqualsUInt8("", new Uint8Array([]))).toBe(true);
 	expect(hexStringEqualsUInt8("", new Uint8Array([0]))).toBe(false);
@@ -1,4 +1,4 @@
-import { blake3, createBLAKE3 } from "../lib";
+import { blake3, blake3DeriveKey, createBLAKE3 } from "../lib";
 /* global test, expect */
 
 test("invalid parameters", async () => {
@@ -71,3 +71,68 @@ test("small digest size", async () => {
 	hash.update("");
 	expect(hash.digest()).toBe("af1349b9");
 });
+
+test("extendable output reader", async () => {
+	const toHex = (data: Uint8Array) => Buffer.from(data).toString("hex");
+
+	const hasher = await createBLAKE3();
+	hasher.update("abc");
+	const reader = hasher.xof();
+	hasher.update("def");
+	const other = hasher.xof();
+
+	const output = reader.read(40000);
+	expect(toHex(output.subarray(0, 100))).toBe(await blake3("abc", 800));
+
+	// reads continue from the current position, across buffer boundaries
+	reader.seek(0);
+	const parts = [reader.read(1), reader.read(16383), reader.read(23616)];
+	expect(Buffer.concat(parts).equals(Buffer.from(output))).toBe(true);
+
+	// the readers of the same instance alternate
+	expect(toHex(other.read(16))).toBe("b34b56076712fd7fb9c067245a6c85e1");
+	expect(toHex(reader.seek(2 ** 40 + 3).read(32))).toBe(
+		"c051242a4feea131458ace7c872b50d63cbd1058143a536562615ac9defa0248",
+	);
+	expect(hasher.digest()).toBe(await blake3("abcdef"));
+	expect(reader.read(0).length).toBe(0);
+
+	expect(() => reader.read(-1)).toThrow();
+	expect(() => reader.seek(-1)).toThrow();
+	hasher.release();
+	expect(() => hasher.xof()).toThrow();
+	expect(() => reader.read(1)).toThrow();
+	expect(() => reader.seek(0)).toThrow();
+});
+
+test("derive_key mode", async () => {
+	expect(
+		await blake3DeriveKey("hash-wasm 2026 test context", "material"),
+	).toBe("d34bfbafbabbea0c5ccdf7d2d48e3c71588f2699521a2d7f23952d2a752c8a4c");
+	expect(await blake3DeriveKey("ctx-3", "x".repeat(20000), 512)).toBe(
+		"058e70bf8853fde4444d93de1029514e7e325ad3ea9eb6ae53c1fd458de755bc" +
+			"6de7c87f7119f4f318f7ede31dc08a0c2945341628c4003d6edbb2f56b5e0e28",
+	);
+
+	// more contexts than cache slots
+	const contexts = Array.from({ length: 20 }, (_, i) => `ctx-${i}`);
+	const keys = [];
+	for (const context of contexts) {
+		keys.push(await blake3DeriveKey(context, "m"));
+	}
+	expect(new Set(keys).size).toBe(20);
+	expect(keys[0]).toBe(
+		"c7026e66d44fcdb394aa1671c2606e01eb2d8d6f3782588383c1015c9f6302cc",
+	);
+	for (const context of contexts.reverse()) {
+		expect(await blake3DeriveKey(context, "m")).toBe(keys.pop());
+	}
+
+	// the derive_key mode does not affect the other modes
+	expect(await blake3("abc")).toBe(
+		"6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85",
+	);
+
+	await expect(blake3DeriveKey(null, "m")).rejects.toThrow();
+	await expect(blake3DeriveKey("ctx", "m", 7)).rejects.toThrow();
+});
@@ -0,0 +1,151 @@
+import {
+	blake3,
+	blake3HashSubtree,
+	blake3MergeSubtrees,
+	blake3Outboard,
+	blake3UpdateOutboard,
+	blake3VerifyRange,
+} from "../lib";
+/* global test, expect */
+
+const getData = (length: number, seed = 0) =>
+	Uint8Array.from({ length }, (_, i) => (i * 31 + seed + (i >> 8)) & 0xff);
+
+test("outboard encoding", async () => {
+	for (const length of [0, 1, 1024, 1025, 2048, 3000, 5121, 40000]) {
+		const data = getData(length);
+		const { hash, outboard } = await blake3Outboard(data);
+		expect(hash).toBe(await blake3(data));
+
+		const chunks = Math.max(1, Math.ceil(length / 1024));
+		expect(outboard.length).toBe(8 + (chunks - 1) * 64);
+		expect(Buffer.from(outboard.subarray(0, 8)).readUInt32LE(0)).toBe(length);
+	}
+});
+
+test("verify ranges", async () => {
+	const data = getData(9000);
+	const { hash, outboard } = await blake3Outboard(data);
+
+	for (let start = 0; start < 9; start++) {
+		for (let end = start + 1; end <= 9; end++) {
+			const range = data.subarray(start * 1024, end * 1024);
+			expect(await blake3VerifyRange(outboard, hash, start * 1024, range)).toBe(
+				true,
+			);
+		}
+	}
+
+	const corrupted = data.slice(2048, 4096);
+	corrupted[100] ^= 1;
+	expect(await blake3VerifyRange(outboard, hash, 2048, corrupted)).toBe(false);
+	expect(
+		await blake3VerifyRange(outboard, hash, 3072, data.subarray(2048, 3072)),
+	).toBe(false);
+
+	const corruptedOutboard = outboard.slice();
+	// right child of the parent node above the first 8 chunks
+	corruptedOutboard[8 + 64 + 32] ^= 1;
+	expect(
+		await blake3VerifyRange(corruptedOutboard, hash, 0, data.subarray(0, 1024)),
+	).toBe(false);
+
+	// the ranges have to be aligned to chunks
+	await expect(
+		blake3VerifyRange(outboard, hash, 100, data.subarray(100, 1124)),
+	).rejects.toThrow();
+	await expect(
+		blake3VerifyRange(outboard, hash, 0, data.subarray(0, 1000)),
+	).rejects.toThrow();
+	await expect(
+		blake3VerifyRange(outboard.subarray(1), hash, 0, data.subarray(0, 1024)),
+	).rejects.toThrow();
+});
+
+test("incremental update", async () => {
+	const data = getData(40000);
+	const { outboard } = await blake3Outboard(data);
+
+	data.set(getData(2048, 7), 17408);
+	const hash = await blake3UpdateOutboard(
+		outboard,
+		17408,
+		data.subarray(17408, 19456),
+	);
+	const encoded = await blake3Outboard(data);
+	expect(hash).toBe(encoded.hash);
+	expect(Buffer.from(outboard).equals(Buffer.from(encoded.outboard))).toBe(
+		true,
+	);
+
+	// last, partial chunk
+	data[39999] ^= 0xff;
+	expect(
+		await blake3UpdateOutboard(outboard, 38912, data.subarray(38912)),
+	).toBe(await blake3(data));
+});
+
+test("subtree merging", async () => {
+	// chunk counts of the subtrees, only the last one can be partial
+	const layouts: [number, number[]][] = [
+		[40000, [32, 8]],
+		[40000, [16, 16, 8]],
+		[40000, [1, 1, 2, 4, 8, 16, 8]],
+		[40000, [16, 8, 4, 2, 1, 1, 8]],
+		[40000, [32, 4, 2, 1, 1]],
+		[35000, [32, 3]],
+		[1025, [1, 1]],
+	];
+
+	for (const [length, layout] of layouts) {
+		const data = getData(length);
+		const subtrees = [];
+		let offset = 0;
+		for (const chunks of layout) {
+			const end = Math.min(offset + chunks * 1024, length);
+			const subtree = await blake3HashSubtree(
+				data.subarray(offset, end),
+				offset / 1024,
+			);
+			expect(subtree.chunks).toBe(chunks);
+			subtrees.push(subtree);
+			offset = end;
+		}
+		expect(await blake3MergeSubtrees(subtrees)).toBe(await blake3(data));
+		expect(await blake3MergeSubtrees(subtrees, 1024)).toBe(
+			await blake3(data, 1024),
+		);
+	}
+});
+
+test("invalid subtrees", async () => {
+	const data = getData(4000);
+	const first = await blake3HashSubtree(data.subarray(0, 2048), 0);
+	const last = await blake3HashSubtree(data.subarray(2048), 2);
+
+	// the offset has to be aligned to the subtree size
+	await expect(blake3HashSubtree(data.subarray(0, 2048), 1)).rejects.toThrow();
+	await expect(blake3HashSubtree(data.subarray(0, 3000), 2)).rejects.toThrow();
+	await expect(blake3HashSubtree(data, -1)).rejects.toThrow();
+	await expect(blake3HashSubtree(new Uint8Array(0), 0)).rejects.toThrow();
+
+	await expect(blake3MergeSubtrees([first])).rejects.toThrow();
+	await expect(blake3MergeSubtrees([last, first])).rejects.toThrow();
+	await expect(blake3MergeSubtrees([first, first])).rejects.toThrow();
+	await expect(blake3MergeSubtrees([first, last], 7)).rejects.toThrow();
+	await expect(
+		blake3MergeSubtrees([first, { ...last, cv: last.cv.subarray(1) }]),
+	).rejects.toThrow();
+
+	// only the last subtree can end with a partial chunk
+	const partial = [
+		await blake3HashSubtree(data.subarray(0, 1000), 0),
+		await blake3HashSubtree(data.subarray(1000, 2024), 1),
+	];
+	await expect(blake3MergeSubtrees(partial)).rejects.toThrow();
+	await expect(
+		blake3MergeSubtrees([{ ...first, length: 2047 }, last]),
+	).rejects.toThrow();
+
+	expect(await blake3MergeSubtrees([first, last])).toBe(await blake3(data));
+});
@@ -0,0 +1,59 @@
+import crypto from "node:crypto";
+import { createSHA1, createSHA256, hashBlob } from "../lib";
+/* global test, expect */
+
+const data = crypto.randomBytes(1024 * 1024 + 123);
+
+test("hash blob", async () => {
+	const blob = new Blob([data]);
+	const expected = crypto.createHash("sha256").update(data).digest("hex");
+	expect(await hashBlob(blob, await createSHA256())).toBe(expected);
+	expect(
+		await hashBlob(blob, await createSHA256(), { chunkSize: 1000 }),
+	).toBe(expected);
+	expect(await hashBlob(new Blob([]), await createSHA256())).toBe(
+		"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+	);
+});
+
+test("hash blob parts", async () => {
+	const blob = new Blob(["a", new Uint8Array([0x62, 0x63]), "😊"]);
+	const result = await hashBlob(blob, await createSHA1(), {
+		chunkSize: 3,
+		outputType: "binary",
+	});
+	expect(Buffer.from(result)).toStrictEqual(
+		crypto.createHash("sha1").update("abc😊").digest(),
+	);
+});
+
+test("progress", async () => {
+	const blob = new Blob([data]);
+	const progress: number[] = [];
+	await hashBlob(blob, await createSHA256(), {
+		chunkSize: 256 * 1024,
+		onProgress: (bytesHashed, totalBytes) => {
+			expect(totalBytes).toBe(data.length);
+			progress.push(bytesHashed);
+		},
+	});
+	expect(progress).toStrictEqual([
+		256 * 1024,
+		512 * 1024,
+		768 * 1024,
+		1024 * 1024,
+		data.length,
+	]);
+});
+
+test("invalid parameters", async () => {
+	const hasher = await createSHA256();
+	const blob = new Blob(["a"]);
+	await expect(hashBlob(null, hasher)).rejects.toThrow();
+	await expect(hashBlob("a" as any, hasher)).rejects.toThrow();
+	await expect(hashBlob(blob, null)).rejects.toThrow();
+	await expect(hashBlob(blob, hasher, { chunkSize: 0 })).rejects.toThrow();
+	await expect(
+		hashBlob(blob, hasher, { outputType: "x" as any }),
+	).rejects.toThrow();
+});
@@ -1,5 +1,5 @@
 import fs from "node:fs";
-import { crc32, createCRC32 } from "../lib";
+import { crc32, crc32Combine, createCRC32 } from "../lib";
 import { getVariableLengthChunks } from "./util";
 /* global test, expect */
 
@@ -119,3 +119,29 @@ test("Invalid inputs throw", async () => {
 		expect(() => hash.update(input as any)).toThrow();
 	}
 });
+
+test("combine", async () => {
+	const data = "The quick brown fox jumps over the lazy dog. ".repeat(50);
+	for (const split of [0, 1, 7, 8, 9, 100, 1000, data.length]) {
+		const first = await crc32(data.slice(0, split));
+		const second = await crc32(data.slice(split));
+		expect(await crc32Combine(first, second, data.length - split)).toBe(
+			await crc32(data),
+		);
+	}
+
+	// compared to zlib's crc32_combine64()
+	expect(await crc32Combine("12345678", "9abcdef0", 2 ** 32 + 5)).toBe(
+		"aa7573df",
+	);
+	expect(await crc32Combine("12345678", "9abcdef0", 2 ** 53 - 1)).toBe(
+		"c376625a",
+	);
+
+	await expect(crc32Combine("1234567", "9abcdef0", 1)).rejects.toThrow();
+	await expect(crc32Combine("1234567x", "9abcdef0", 1)).rejects.toThrow();
+	await expect(crc32Combine("12345678", "9abcdef0", -1)).rejects.toThrow();
+	await expect(crc32Combine("12345678", "9abcdef0", 0.5)).rejects.toThrow();
+	await expect(crc32Combine("12345678", "9abcdef0", 2 ** 53)).rejects.toThrow();
+	await expect(crc32Combine("12345678", "9abcdef0", 1, -1)).rejects.toThrow();
+});
@@ -1,5 +1,5 @@
 import fs from "node:fs";
-import { crc32, createCRC32 } from "../lib";
+import { crc32, crc32Combine, createCRC32 } from "../lib";
 import { getVariableLengthChunks } from "./util";
 /* global test, expect */
 
@@ -126,3 +126,34 @@ test("Invalid inputs throw", async () => {
 		expect(() => hash.update(input as any)).toThrow();
 	}
 });
+
+test("combine", async () => {
+	const data = "The quick brown fox jumps over the lazy dog. ".repeat(50);
+	for (const split of [0, 1, 7, 8, 9, 100, 1000, data.length]) {
+		const first = await crc32(data.slice(0, split), POLY);
+		const second = await crc32(data.slice(split), POLY);
+		expect(
+			await crc32Combine(first, second, data.length - split, POLY),
+		).toBe(await crc32(data, POLY));
+	}
+
+	// combining is associative, also with long parts
+	const [a, b, c] = ["12345678", "9abcdef0", "0fedcba9"];
+	const lengthB = 2 ** 40 + 3;
+	const lengthC = 2 ** 45 + 11;
+	expect(
+		await crc32Combine(
+			await crc32Combine(a, b, lengthB, POLY),
+			c,
+			lengthC,
+			POLY,
+		),
+	).toBe(
+		await crc32Combine(
+			a,
+			await crc32Combine(b, c, lengthC, POLY),
+			lengthB + lengthC,
+			POLY,
+		),
+	);
+});
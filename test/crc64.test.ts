@@ -1,5 +1,5 @@
 import fs from "node:fs";
-import { crc64, createCRC64 } from "../lib";
+import { crc64, crc64Combine, createCRC64 } from "../lib";
 import { getVariableLengthChunks } from "./util";
 /* global test, expect */
 
@@ -137,3 +137,31 @@ test("with iso poly", async () => {
 	hash.update("4567890");
 	expect(hash.digest()).toBe("43990956c775a410");
 });
+
+test("combine", async () => {
+	const data = "The quick brown fox jumps over the lazy dog. ".repeat(50);
+	for (const poly of [undefined, ISO_POLY]) {
+		for (const split of [0, 1, 7, 8, 9, 100, 1000, data.length]) {
+			const first = await crc64(data.slice(0, split), poly);
+			const second = await crc64(data.slice(split), poly);
+			expect(
+				await crc64Combine(first, second, data.length - split, poly),
+			).toBe(await crc64(data, poly));
+		}
+	}
+
+	// combining is associative, also with long parts
+	const a = "0123456789abcdef";
+	const b = "fedcba9876543210";
+	const c = "00ff00ff00ff00ff";
+	const lengthB = 2 ** 40 + 3;
+	const lengthC = 2 ** 45 + 11;
+	const bc = await crc64Combine(b, c, lengthC);
+	expect(
+		await crc64Combine(await crc64Combine(a, b, lengthB), c, lengthC),
+	).toBe(await crc64Combine(a, bc, lengthB + lengthC));
+
+	await expect(crc64Combine("12345678", "9abcdef0", 1)).rejects.toThrow();
+	await expect(crc64Combine(a, b, -1)).rejects.toThrow();
+	await expect(crc64Combine(a, b, 1, "123")).rejects.toThrow();
+});
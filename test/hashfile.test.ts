@@ -0,0 +1,58 @@
+import crypto from "node:crypto";
+import fs from "node:fs";
+import os from "node:os";
+import path from "node:path";
+import { createMD5, createSHA256 } from "../lib";
+import { hashFile } from "../lib/node";
+/* global test, expect, beforeAll, afterAll */
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), "hash-wasm-"));
+const filePath = path.join(dir, "data.bin");
+const emptyPath = path.join(dir, "empty.bin");
+const data = crypto.randomBytes(1024 * 1024 + 123);
+
+beforeAll(() => {
+	fs.writeFileSync(filePath, data);
+	fs.writeFileSync(emptyPath, "");
+});
+
+afterAll(() => {
+	fs.rmSync(dir, { recursive: true, force: true });
+});
+
+test("single hasher", async () => {
+	expect(await hashFile(filePath, await createSHA256())).toBe(
+		crypto.createHash("sha256").update(data).digest("hex"),
+	);
+	expect(await hashFile(emptyPath, await createSHA256())).toBe(
+		"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+	);
+});
+
+test("multiple hashers", async () => {
+	const sha256 = await createSHA256();
+	const md5 = await createMD5();
+	for (const chunkSize of [1000, 16 * 1024, 2 * 1024 * 1024]) {
+		const [a, b] = await hashFile(filePath, [sha256, md5], {
+			chunkSize,
+			outputType: "binary",
+		});
+		expect(Buffer.from(a)).toStrictEqual(
+			crypto.createHash("sha256").update(data).digest(),
+		);
+		expect(Buffer.from(b)).toStrictEqual(
+			crypto.createHash("md5").update(data).digest(),
+		);
+	}
+});
+
+test("invalid parameters", async () => {
+	const hasher = await createSHA256();
+	await expect(hashFile(path.join(dir, "missing"), hasher)).rejects.toThrow();
+	await expect(hashFile(filePath, null)).rejects.toThrow();
+	await expect(hashFile(filePath, [])).rejects.toThrow();
+	await expect(hashFile(filePath, hasher, { chunkSize: 0 })).rejects.toThrow();
+	await expect(
+		hashFile(filePath, hasher, { outputType: "x" as any }),
+	).rejects.toThrow();
+});
@@ -79,10 +79,28 @@ test("invalid parameters", async () => {
 	expect(() => createHMAC(hasher as any, "x")).toThrow();
 });
 
-test("save and load should throw", async () => {
-	const hmac = await createHMAC(md5Hasher, "key1");
+test("save and load", async () => {
+	const hmac = await createHMAC(createSHA256(), "key1");
+	hmac.update("a");
+	const saved = hmac.save();
+	hmac.update("bc");
+	expect(hmac.digest()).toBe(getNodeHMAC("sha256", "key1", "abc"));
 	expect(() => hmac.save()).toThrow();
+
+	hmac.load(saved);
+	expect(hmac.digest()).toBe(getNodeHMAC("sha256", "key1", "a"));
+	expect(hmac.load(saved).update("xyz").digest()).toBe(
+		getNodeHMAC("sha256", "key1", "axyz"),
+	);
+
+	const other = await createHMAC(createSHA256(), "key1");
+	other.load(saved);
+	other.update("bc");
+	expect(other.digest()).toBe(getNodeHMAC("sha256", "key1", "abc"));
+
 	expect(() => hmac.load(new Uint8Array([]))).toThrow();
+	const md5Hmac = await createHMAC(md5Hasher, "key1");
+	expect(() => md5Hmac.load(saved)).toThrow();
 });
 
 test("simple test", async () => {
@@ -99,6 +117,22 @@ test("can reuse a single hasher", async () => {
 	expect(hasher.digest()).toBe(getNodeHMAC("md5", "key2", "xyz"));
 });
 
+test("HMAC instances can take turns on a single hasher", async () => {
+	const algo = createSHA512();
+	const hmac1 = await createHMAC(algo, "key1");
+	const hmac2 = await createHMAC(algo, "key2");
+	for (let i = 0; i < 3; i++) {
+		hmac1.init().update("abc");
+		expect(hmac1.digest()).toBe(getNodeHMAC("sha512", "key1", "abc"));
+		hmac2.init().update("xyz");
+		expect(hmac2.digest()).toBe(getNodeHMAC("sha512", "key2", "xyz"));
+		expect(hmac1.hashMany(["a", "b"])).toStrictEqual([
+			getNodeHMAC("sha512", "key1", "a"),
+			getNodeHMAC("sha512", "key1", "b"),
+		]);
+	}
+});
+
 test("no interference between parallel hashes", async () => {
 	const hasher1 = await createHMAC(createMD5(), "key1");
 	const hasher2 = await createHMAC(createMD5(), "key2");
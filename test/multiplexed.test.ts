@@ -0,0 +1,96 @@
+import crypto from "node:crypto";
+import {
+	createBLAKE3,
+	createBLAKE3Sync,
+	createHMAC,
+	createKeccak,
+	createSHA3,
+	createSHA224,
+	createSHA256,
+	createSHA256Sync,
+	keccak,
+	sha3,
+} from "../lib";
+
+/* global test, expect */
+
+const nodeHash = (algorithm: string, data: string) =>
+	crypto.createHash(algorithm).update(data).digest("hex");
+
+test("interleaved multiplexed hashers", async () => {
+	const hashers = await Promise.all(
+		Array.from({ length: 2000 }, (_, i) =>
+			i % 2
+				? createSHA224({ multiplexed: true })
+				: createSHA256({ multiplexed: true }),
+		),
+	);
+
+	const inputs = hashers.map(() => "");
+	for (let round = 0; round < 3; round++) {
+		hashers.forEach((hasher, i) => {
+			const chunk = `${i}-${round}-`.repeat(i % 37);
+			hasher.update(chunk);
+			inputs[i] += chunk;
+		});
+	}
+
+	hashers.forEach((hasher, i) => {
+		const algorithm = i % 2 ? "sha224" : "sha256";
+		expect(hasher.digest()).toBe(nodeHash(algorithm, inputs[i]));
+		hasher.release();
+	});
+});
+
+test("multiplexed SHA-3 and Keccak share the module", async () => {
+	const sha3Hasher = await createSHA3(256, { multiplexed: true });
+	const keccakHasher = await createKeccak(512, { multiplexed: true });
+
+	sha3Hasher.update("a");
+	keccakHasher.update("a");
+	sha3Hasher.update("bc");
+	keccakHasher.update("bc");
+
+	expect(sha3Hasher.digest()).toBe(await sha3("abc", 256));
+	expect(keccakHasher.digest()).toBe(await keccak("abc", 512));
+});
+
+test("multiplexed save(), load() and HMAC", async () => {
+	const first = createSHA256Sync({ multiplexed: true });
+	const second = createSHA256Sync({ multiplexed: true });
+
+	first.update("abc");
+	const state = first.save();
+	first.update("def");
+	second.load(state);
+	second.update("xyz");
+	expect(first.digest()).toBe(nodeHash("sha256", "abcdef"));
+	expect(second.digest()).toBe(nodeHash("sha256", "abcxyz"));
+
+	const hmac = await createHMAC(createSHA256({ multiplexed: true }), "key");
+	first.init();
+	hmac.update("abc");
+	first.update("x");
+	expect(hmac.digest()).toBe(
+		crypto.createHmac("sha256", "key").update("abc").digest("hex"),
+	);
+	expect(first.digest()).toBe(nodeHash("sha256", "x"));
+});
+
+test("released multiplexed hashers", async () => {
+	const hasher = await createSHA256({ multiplexed: true });
+	hasher.release();
+	expect(() => hasher.init()).toThrow();
+	expect(() => hasher.update("a")).toThrow();
+
+	const next = await createSHA256({ multiplexed: true });
+	next.update("a");
+	expect(next.digest()).toBe(nodeHash("sha256", "a"));
+});
+
+test("unsupported algorithms", async () => {
+	await expect(
+		createBLAKE3(256, null, { multiplexed: true }),
+	).rejects.toThrow();
+	expect(() => createBLAKE3Sync(256, null, { multiplexed: true })).toThrow();
+});
@@ -1,5 +1,12 @@
 import crypto from "node:crypto";
-import { createSHA512, pbkdf2 } from "../lib";
+import {
+	createMD5,
+	createSHA1,
+	createSHA256,
+	createSHA384,
+	createSHA512,
+	pbkdf2,
+} from "../lib";
 
 /* global test, expect */
 
@@ -108,6 +115,53 @@ test("various key lengths", async () => {
 	expect(await getWasmPBKDF2("password", "salt", 500, 600)).toBe(
 		getNodePBKDF2("password", "salt", 500, 600),
 	);
+
+	// does not fit into the WASM buffer
+	expect(await getWasmPBKDF2("password", "salt", 2, 20000)).toBe(
+		getNodePBKDF2("password", "salt", 2, 20000),
+	);
+});
+
+test("other hash functions", async () => {
+	for (const [name, hashFunction] of [
+		["sha1", createSHA1],
+		["sha256", createSHA256],
+		["sha384", createSHA384],
+		["md5", createMD5],
+	] as const) {
+		const hash = await pbkdf2({
+			password: "password",
+			salt: "salt",
+			iterations: 1000,
+			hashLength: 70,
+			hashFunction: hashFunction(),
+		});
+		expect(hash).toBe(
+			crypto.pbkdf2Sync("password", "salt", 1000, 70, name).toString("hex"),
+		);
+	}
+});
+
+test("long salts with multiple blocks", async () => {
+	for (const saltLength of [252, 253, 256, 260, 300, 1000]) {
+		const salt = Uint8Array.from({ length: saltLength }, (_, i) => i * 3);
+		for (const [name, hashFunction] of [
+			["sha1", createSHA1],
+			["sha256", createSHA256],
+			["sha512", createSHA512],
+		] as const) {
+			const hash = await pbkdf2({
+				password: "password",
+				salt,
+				iterations: 3,
+				hashLength: 200,
+				hashFunction: hashFunction(),
+			});
+			expect(hash).toBe(
+				crypto.pbkdf2Sync("password", salt, 3, 200, name).toString("hex"),
+			);
+		}
+	}
 });
 
 test("various iteration counts", async () => {
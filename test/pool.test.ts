@@ -0,0 +1,91 @@
+/* global test, expect */
+
+beforeEach(() => {
+	jest.resetModules();
+});
+
+test("released instances are reused", async () => {
+	const api = jest.requireActual("../lib");
+
+	const first = await api.createSHA256({ pooled: true });
+	first.update("abc");
+	const hash = first.digest();
+	expect(api.getPoolStats().sha256.inUse).toBe(1);
+	expect(api.getPoolStats().sha256.memoryBytes).toBeGreaterThan(0);
+
+	first.release();
+	first.release();
+	expect(api.getPoolStats().sha256).toMatchObject({ idle: 1, inUse: 0 });
+	expect(() => first.init()).toThrow();
+	expect(() => first.update("abc")).toThrow();
+
+	const second = api.createSHA256Sync({ pooled: true });
+	expect(api.getPoolStats().sha256).toMatchObject({ idle: 0, inUse: 1 });
+	second.update("abc");
+	expect(second.digest()).toBe(hash);
+});
+
+test("unpooled hashers are not tracked", async () => {
+	const api = jest.requireActual("../lib");
+
+	const hasher = await api.createMD5();
+	hasher.release();
+	expect(api.getPoolStats().md5).toBeUndefined();
+	expect(() => hasher.init()).toThrow();
+});
+
+test("pooled instances are reset for new parameters", async () => {
+	const api = jest.requireActual("../lib");
+
+	const keyed = await api.createBLAKE2b(256, "key", { pooled: true });
+	keyed.update("abc");
+	keyed.digest();
+	keyed.release();
+
+	const hasher = await api.createBLAKE2b(512, null, { pooled: true });
+	expect(api.getPoolStats().blake2b.idle).toBe(0);
+	hasher.update("abc");
+	expect(hasher.digest()).toBe(await api.blake2b("abc"));
+	hasher.release();
+
+	const hmac = await api.createHMAC(
+		api.createBLAKE2b(512, null, { pooled: true }),
+		"key",
+	);
+	hmac.update("abc");
+	const hmacHash = hmac.digest();
+	hmac.release();
+	expect(api.getPoolStats().blake2b).toMatchObject({ idle: 1, inUse: 0 });
+
+	const hmac2 = api.createHMACSync(
+		api.createBLAKE2bSync(512, null, { pooled: true }),
+		"key",
+	);
+	hmac2.update("abc");
+	expect(hmac2.digest()).toBe(hmacHash);
+});
+
+test("pool size", async () => {
+	const api = jest.requireActual("../lib");
+
+	const hashers = await Promise.all([
+		api.createCRC32(undefined, { pooled: true }),
+		api.createCRC32(undefined, { pooled: true }),
+		api.createCRC32(undefined, { pooled: true }),
+	]);
+	api.setMaxPoolSize(2);
+	for (const hasher of hashers) {
+		hasher.release();
+	}
+	expect(api.getPoolStats().crc32).toMatchObject({ idle: 2, inUse: 0 });
+
+	api.setMaxPoolSize(0);
+	expect(api.getPoolStats().crc32).toMatchObject({
+		idle: 0,
+		inUse: 0,
+		memoryBytes: 0,
+	});
+
+	expect(() => api.setMaxPoolSize(-1)).toThrow();
+	expect(() => api.setMaxPoolSize(1.5)).toThrow();
+});
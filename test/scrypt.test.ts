@@ -1,4 +1,5 @@
-import { scrypt } from "../lib";
+import { createScryptEngine, scrypt } from "../lib";
+import { isMemory64Supported } from "./util";
 /* global test, expect */
 
 const hash = async (
@@ -57,6 +58,24 @@ test("scrypt", async () => {
 	);
 });
 
+test("long password, salt and hash length", async () => {
+	const result = await hash(
+		"p".repeat(100),
+		"s".repeat(300),
+		16,
+		2,
+		3,
+		100,
+		"hex",
+	);
+	expect(result).toBe(
+		"44b12e88eafbb7a30b8b1187ee104d82c549e5295202a018ac6f5d12b9b78f3c" +
+			"0131b26a71afc3ac98d6590a9960b4bb56142edc66bb902072174adc42bc0b58" +
+			"be0a5d55c6d34dfdcc01e3423e6a7b336b901a812e8aa35e9aeca108624416bd" +
+			"65417c65",
+	);
+});
+
 test("scrypt official test vectors", async () => {
 	expect(await hash("", "", 16, 1, 1, 64, "hex")).toBe(
 		"77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906",
@@ -128,3 +147,63 @@ test("invalid parameters", async () => {
 	await expect(() => (scrypt as any)({})).rejects.toThrow();
 	await expect(() => (scrypt as any)(1)).rejects.toThrow();
 });
+
+test("engine reuses the instance", async () => {
+	const engine = await createScryptEngine({ maxMemory: 1024 * 1024 });
+	const options = {
+		password: "password",
+		salt: "salt",
+		blockSize: 8,
+		parallelism: 1,
+		hashLength: 32,
+	};
+
+	for (const costFactor of [16, 512, 2, 64]) {
+		expect(await engine.scrypt({ ...options, costFactor })).toBe(
+			await scrypt({ ...options, costFactor }),
+		);
+	}
+
+	// needs 128 * 8 * (1024 + 1) + 256 * 8 + 64 bytes, more than maxMemory
+	await expect(
+		engine.scrypt({ ...options, costFactor: 1024 }),
+	).rejects.toThrow();
+	await expect(engine.scrypt({ ...options, costFactor: 3 })).rejects.toThrow();
+
+	engine.dispose();
+	await expect(engine.scrypt({ ...options, costFactor: 2 })).rejects.toThrow();
+});
+
+test("memory64 build", async () => {
+	const options = {
+		password: "password",
+		salt: "NaCl",
+		costFactor: 1024,
+		blockSize: 8,
+		parallelism: 16,
+		hashLength: 64,
+	};
+
+	if (!isMemory64Supported()) {
+		await expect(
+			scrypt({ ...options, costFactor: 2 ** 22 }),
+		).rejects.toThrow("does not support memory64");
+		return;
+	}
+
+	// the engine uses the memory64 build if maxMemory is over 2 GiB
+	const engine = await createScryptEngine({ maxMemory: 4 * 1024 ** 3 });
+	expect(await engine.scrypt(options)).toBe(
+		"fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162" +
+			"2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640",
+	);
+	engine.dispose();
+
+	// 128 * 16 * 2^24 bytes = 32 GiB is over the limit of the memory64 build
+	await expect(
+		scrypt({ ...options, costFactor: 2 ** 24, blockSize: 16 }),
+	).rejects.toThrow();
+	await expect(
+		createScryptEngine({ maxMemory: 32 * 1024 ** 3 }),
+	).rejects.toThrow();
+});
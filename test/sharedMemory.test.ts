@@ -0,0 +1,60 @@
+import crypto from "node:crypto";
+import path from "node:path";
+
+/* global test, expect */
+
+const WASM_DIR = path.resolve(__dirname, "..", "wasm");
+
+beforeEach(() => {
+	jest.resetModules();
+});
+
+const nodeHash = (algorithm: string, data: string) =>
+	crypto.createHash(algorithm).update(data).digest("hex");
+
+test("enableSharedMemory() needs a WASM location", () => {
+	const { enableSharedMemory } = jest.requireActual("../lib");
+	expect(() => enableSharedMemory()).toThrow();
+});
+
+test("shared memory", async () => {
+	const api = jest.requireActual("../lib");
+	api.setWASMLocation(WASM_DIR);
+	api.enableSharedMemory();
+
+	// the second SHA-256 instance gets a separate memory
+	const hashers = await Promise.all([
+		api.createSHA256(),
+		api.createSHA256(),
+		api.createMD5(),
+		api.createSHA512(),
+		api.createSHA1(),
+	]);
+	const algorithms = ["sha256", "sha256", "md5", "sha512", "sha1"];
+
+	for (const hasher of hashers) {
+		hasher.init();
+	}
+	for (let i = 0; i < 100; i++) {
+		for (const [index, hasher] of hashers.entries()) {
+			hasher.update(`${index}-${i}`);
+		}
+	}
+
+	hashers.forEach((hasher, index) => {
+		let data = "";
+		for (let i = 0; i < 100; i++) {
+			data += `${index}-${i}`;
+		}
+		expect(hasher.digest()).toBe(nodeHash(algorithms[index], data));
+	});
+
+	expect(await api.sha256("abc")).toBe(nodeHash("sha256", "abc"));
+	expect(await api.blake2b("abc")).toBe(nodeHash("blake2b512", "abc"));
+
+	const hmac = await api.createHMAC(api.createSHA256(), "key");
+	hmac.update("abc");
+	expect(hmac.digest()).toBe(
+		crypto.createHmac("sha256", "key").update("abc").digest("hex"),
+	);
+});
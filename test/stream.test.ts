@@ -0,0 +1,94 @@
+import crypto from "node:crypto";
+import { Readable } from "node:stream";
+import { pipeline } from "node:stream/promises";
+import { createHashSink, createMD5, createSHA256 } from "../lib";
+import { createHashStream } from "../lib/node";
+import { getVariableLengthChunks } from "./util";
+/* global test, expect */
+
+const chunks = getVariableLengthChunks(1024).map((chunk) =>
+	Buffer.from(chunk),
+);
+const allData = Buffer.concat(chunks);
+const expected = crypto.createHash("sha256").update(allData).digest("hex");
+
+test("Node.js stream", async () => {
+	const stream = createHashStream(await createSHA256());
+	await pipeline(Readable.from(chunks), stream);
+	expect(stream.read()).toBe(expected);
+});
+
+test("Node.js stream with large chunks", async () => {
+	const buf = Buffer.alloc(100 * 1024 + 3, 0xab);
+	const stream = createHashStream(await createSHA256(), {
+		outputType: "binary",
+		highWaterMark: 1024,
+	});
+	await pipeline(Readable.from([buf, Buffer.from("x"), buf]), stream);
+	const nodeHash = crypto
+		.createHash("sha256")
+		.update(buf)
+		.update("x")
+		.update(buf)
+		.digest();
+	expect(Buffer.from(stream.read())).toStrictEqual(nodeHash);
+});
+
+test("Node.js stream with strings", async () => {
+	const stream = createHashStream(await createMD5());
+	stream.write("a");
+	stream.write(new Uint8Array([0x62]));
+	stream.write("6364", "hex");
+	stream.end("😊");
+	const result = await new Promise((resolve) => stream.on("data", resolve));
+	expect(result).toBe(
+		crypto.createHash("md5").update("abcd😊").digest("hex"),
+	);
+});
+
+test("WritableStream sink invalid data", async () => {
+	const { writable, digest } = createHashSink(await createSHA256());
+	const writer = writable.getWriter();
+	await expect(writer.write(123 as any)).rejects.toThrow();
+	await expect(digest).rejects.toThrow();
+});
+
+test("WritableStream sink", async () => {
+	const { writable, digest } = createHashSink(await createSHA256());
+	await Readable.toWeb(Readable.from(chunks)).pipeTo(writable);
+	expect(await digest).toBe(expected);
+});
+
+test("WritableStream sink binary output", async () => {
+	const { writable, digest } = createHashSink(await createSHA256(), {
+		outputType: "binary",
+		highWaterMark: 16,
+	});
+	const writer = writable.getWriter();
+	for (const chunk of chunks) {
+		await writer.ready;
+		writer.write(chunk);
+	}
+	await writer.close();
+	expect(Buffer.from((await digest) as Uint8Array).toString("hex")).toBe(
+		expected,
+	);
+});
+
+test("WritableStream sink abort", async () => {
+	const { writable, digest } = createHashSink(await createSHA256());
+	const writer = writable.getWriter();
+	await writer.write(new Uint8Array([1, 2, 3]));
+	await writer.abort(new Error("aborted"));
+	await expect(digest).rejects.toThrow("aborted");
+});
+
+test("invalid parameters", async () => {
+	const hasher = await createSHA256();
+	expect(() => createHashSink(null)).toThrow();
+	expect(() => createHashSink({} as any)).toThrow();
+	expect(() => createHashSink(hasher, { outputType: "x" as any })).toThrow();
+	expect(() => createHashSink(hasher, { highWaterMark: -1 })).toThrow();
+	expect(() => createHashStream(null)).toThrow();
+	expect(() => createHashStream(hasher, { highWaterMark: 0.5 })).toThrow();
+});
@@ -0,0 +1,78 @@
+/* global test, expect */
+import {
+	blake2b,
+	blake3,
+	crc32,
+	createBLAKE2bSync,
+	createBLAKE3Sync,
+	createCRC32Sync,
+	createHMAC,
+	createHMACSync,
+	createSHA3Sync,
+	createSHA256,
+	createSHA256Sync,
+	createXXHash64Sync,
+	preload,
+	sha3,
+	sha256,
+	xxhash64,
+} from "../lib";
+
+test("sync factories", async () => {
+	const sha = createSHA256Sync();
+	sha.update("abc");
+	expect(sha.digest()).toBe(await sha256("abc"));
+
+	const sha3Hasher = createSHA3Sync(224);
+	sha3Hasher.update("abc");
+	expect(sha3Hasher.digest()).toBe(await sha3("abc", 224));
+
+	const blake2bHasher = createBLAKE2bSync(256, "key");
+	blake2bHasher.update("abc");
+	expect(blake2bHasher.digest()).toBe(await blake2b("abc", 256, "key"));
+
+	const key = new Uint8Array(32).fill(7);
+	const blake3Hasher = createBLAKE3Sync(512, key);
+	blake3Hasher.update("abc");
+	expect(blake3Hasher.digest()).toBe(await blake3("abc", 512, key));
+
+	const crc = createCRC32Sync(0x82f63b78);
+	crc.update("abc");
+	expect(crc.digest()).toBe(await crc32("abc", 0x82f63b78));
+
+	const xxhash = createXXHash64Sync(1, 2);
+	xxhash.update("abc");
+	expect(xxhash.digest()).toBe(await xxhash64("abc", 1, 2));
+});
+
+test("sync factories validate parameters", () => {
+	expect(() => createSHA3Sync(100 as any)).toThrow();
+	expect(() => createBLAKE2bSync(256, new Uint8Array(65))).toThrow();
+	expect(() => createBLAKE3Sync(256, new Uint8Array(31))).toThrow();
+	expect(() => createCRC32Sync(-1)).toThrow();
+	expect(() => createXXHash64Sync(-1)).toThrow();
+});
+
+test("sync HMAC", async () => {
+	const hmac = createHMACSync(createSHA256Sync(), "key");
+	hmac.update("abc");
+	const hmacAsync = await createHMAC(createSHA256(), "key");
+	hmacAsync.update("abc");
+	expect(hmac.digest()).toBe(hmacAsync.digest());
+
+	expect(() => createHMACSync(null, "key")).toThrow();
+	expect(() => createHMACSync(createSHA256() as any, "key")).toThrow();
+});
+
+test("preload", async () => {
+	await expect(preload(["sha256", "blake3", "keccak"])).resolves.toBe(
+		undefined,
+	);
+	await expect(preload([])).resolves.toBe(undefined);
+	await expect(preload(["unknown" as any])).rejects.toThrow();
+	await expect(preload("sha256" as any)).rejects.toThrow();
+
+	const sha = createSHA256Sync();
+	sha.update("a");
+	expect(sha.digest()).toBe(await sha256("a"));
+});
@@ -21,3 +21,12 @@ export const getVariableLengthChunks = (maxLen: number): number[][] => {
 
 	return chunks;
 };
+
+// (module (memory i64 0)), only valid if the engine supports memory64
+export const isMemory64Supported = (): boolean =>
+	WebAssembly.validate(
+		new Uint8Array([
+			0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x05, 0x03, 0x01, 0x04,
+			0x00,
+		]),
+	);
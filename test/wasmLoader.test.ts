@@ -0,0 +1,65 @@
+import fs from "node:fs";
+import path from "node:path";
+
+/* global test, expect */
+
+const WASM_DIR = path.resolve(__dirname, "..", "wasm");
+const SHA1_A = "86f7e437faa5a7fce15d1ddcb9eaeaea377667b8";
+
+beforeEach(() => {
+	jest.resetModules();
+});
+
+afterEach(() => {
+	jest.restoreAllMocks();
+});
+
+test("loads .wasm files from a directory", async () => {
+	const { md5, setWASMLocation } = jest.requireActual("../lib");
+
+	const fileNames: string[] = [];
+	setWASMLocation((fileName: string) => {
+		fileNames.push(fileName);
+		// a different binary proves that the file was used
+		return path.join(WASM_DIR, "sha1.wasm");
+	});
+
+	expect(await md5("a")).toBe(SHA1_A.substring(0, 32));
+	expect(fileNames).toStrictEqual(["md5.wasm"]);
+});
+
+test("fetches .wasm files from URLs", async () => {
+	const { sha1, setWASMLocation } = jest.requireActual("../lib");
+
+	const fetchMock = jest.spyOn(globalThis, "fetch").mockImplementation(
+		async () =>
+			new Response(fs.readFileSync(path.join(WASM_DIR, "sha1.wasm")), {
+				headers: { "Content-Type": "application/wasm" },
+			}),
+	);
+	setWASMLocation("https://example.com/wasm");
+
+	expect(await sha1("a")).toBe(SHA1_A);
+	expect(fetchMock).toHaveBeenCalledWith("https://example.com/wasm/sha1.wasm");
+});
+
+test("falls back to the embedded binaries", async () => {
+	const { sha1, md5, setWASMLocation } = jest.requireActual("../lib");
+
+	jest
+		.spyOn(globalThis, "fetch")
+		.mockImplementation(async () => new Response("", { status: 404 }));
+	setWASMLocation("https://example.com/wasm/");
+	expect(await sha1("a")).toBe(SHA1_A);
+
+	setWASMLocation(path.join(WASM_DIR, "missing"));
+	expect(await md5("a")).toBe("0cc175b9c0f1b6a831c399e269772661");
+});
+
+test("invalid locations", () => {
+	const { setWASMLocation } = jest.requireActual("../lib");
+
+	expect(() => setWASMLocation(1)).toThrow();
+	expect(() => setWASMLocation({})).toThrow();
+	expect(() => setWASMLocation(null)).not.toThrow();
+});